@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+# Compares diagnostics (errors, warnings and their positions) printed by two translator binaries.
+#
+# Every given source (code_examples/*.txt by default) is compiled by both binaries and the
+# output before "Generated RPN:" is compared byte by byte. Run it with the binary built before
+# a change as --base to check the change does not alter diagnostics.
+
+import argparse
+import glob
+import os
+import subprocess
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def diagnostics(binary, source):
+  try:
+    proc = subprocess.run([binary, '-c', source], stdin=subprocess.DEVNULL, stdout=subprocess.PIPE,
+                          stderr=subprocess.STDOUT, timeout=60)
+  except subprocess.TimeoutExpired:
+    return b'<timeout>'
+  out = proc.stdout.split(b'Generated RPN:')[0]
+  if proc.returncode < 0:
+    out += b'<killed by signal %d>' % -proc.returncode
+  return out
+
+
+def main():
+  parser = argparse.ArgumentParser(description='Compare diagnostics of two translator binaries')
+  parser.add_argument('--base', required=True, help='binary built before the change')
+  parser.add_argument('--bin', default=os.path.join(ROOT, 'bin', 'app-bench'))
+  parser.add_argument('sources', nargs='*', help='sources to compile (default: code_examples/*.txt)')
+  args = parser.parse_args()
+
+  sources = args.sources or sorted(glob.glob(os.path.join(ROOT, 'code_examples', '*.txt')))
+  different = 0
+  for source in sources:
+    old = diagnostics(args.base, source)
+    new = diagnostics(args.bin, source)
+    if old == new:
+      print('%-40s same' % os.path.relpath(source))
+      continue
+    different += 1
+    print('%-40s DIFFERENT' % os.path.relpath(source))
+    old_lines, new_lines = old.splitlines(), new.splitlines()
+    for i in range(max(len(old_lines), len(new_lines))):
+      old_line = old_lines[i] if i < len(old_lines) else b''
+      new_line = new_lines[i] if i < len(new_lines) else b''
+      if old_line != new_line:
+        print('  base: %s' % old_line.decode(errors='replace'))
+        print('  new:  %s' % new_line.decode(errors='replace'))
+        break
+  print('%d of %d sources have different diagnostics' % (different, len(sources)))
+  return 1 if different else 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+# Deterministic generator of large valid programs for compiler scalability benchmarks.
+#
+# Every function fn<i> declares a few literals and a struct instance, runs nested
+# for/while/if blocks <depth> levels deep and calls fn<i/2>, so call depth stays
+# logarithmic. Global code calls every function once.
+
+import argparse
+import random
+import sys
+
+
+class Generator:
+  def __init__(self, functions, depth, loops, structs, literals, seed):
+    self.functions = max(functions, 1)
+    self.depth = depth
+    self.loops = loops
+    self.structs = max(structs, 1)
+    self.literals = literals
+    self.rng = random.Random(seed)
+    self.out = []
+
+  def emit(self, indent, line):
+    self.out.append('  ' * indent + line)
+
+  def int_literal(self):
+    return str(self.rng.randint(1, 99))
+
+  def struct(self, k):
+    self.emit(0, 'struct S%d {' % k)
+    self.emit(1, 'int32 a = %s;' % self.int_literal())
+    self.emit(1, 'int64 b = %s;' % self.int_literal())
+    self.emit(1, 'f64 d = %d.%d;' % (self.rng.randint(0, 9), self.rng.randint(0, 99)))
+    self.emit(1, "char c = '%s';" % self.rng.choice('abcdefghijklmnopqrstuvwxyz'))
+    self.emit(0, '}')
+
+  def literal_statements(self, indent):
+    for _ in range(self.literals):
+      choice = self.rng.randrange(3)
+      if choice == 0:
+        self.emit(indent, 'acc += %s;' % self.int_literal())
+      elif choice == 1:
+        self.emit(indent, 'if (acc > %s) acc -= %s;' % (self.int_literal(), self.int_literal()))
+      else:
+        self.emit(indent, 'acc = acc %% %d + s.a;' % (self.rng.randint(100, 999)))
+
+  def block(self, indent, level):
+    if level == self.depth:
+      self.literal_statements(indent)
+      return
+    for loop in range(self.loops):
+      var = 'j%d_%d' % (level, loop)
+      if (level + loop) % 2 == 0:
+        self.emit(indent, 'for (int32 %s = 0; %s < 2; ++%s) {' % (var, var, var))
+      else:
+        self.emit(indent, 'int32 %s = 0;' % var)
+        self.emit(indent, 'while (%s < 2) {' % var)
+        self.emit(indent + 1, '++%s;' % var)
+      self.emit(indent + 1, 'if (acc > %s) {' % self.int_literal())
+      self.block(indent + 2, level + 1)
+      self.emit(indent + 1, '} else {')
+      self.emit(indent + 2, 'acc += y * %s;' % self.int_literal())
+      self.emit(indent + 1, '}')
+      self.emit(indent, '}')
+
+  def function(self, i):
+    k = i % self.structs
+    self.emit(0, 'int32 fn%d(int32 x, int32 y) {' % i)
+    self.emit(1, 'int32 acc = x;')
+    self.emit(1, 'char name%d[] = "function %d";' % (i, i))
+    self.emit(1, 'S%d s = S%d();' % (k, k))
+    self.emit(1, 's.a = acc %% %s;' % self.int_literal())
+    self.block(1, 0)
+    self.emit(1, 'acc += size(name%d);' % i)
+    if i > 0:
+      self.emit(1, 'acc += fn%d(acc %% 100, y) %% 10;' % (i // 2))
+    self.emit(1, 'return acc % 1000;')
+    self.emit(0, '}')
+
+  def generate(self):
+    self.emit(0, '// Generated by bench/gen.py')
+    for k in range(self.structs):
+      self.struct(k)
+    for i in range(self.functions):
+      self.function(i)
+    self.emit(0, 'int64 total = 0;')
+    for i in range(self.functions):
+      self.emit(0, 'total += fn%d(%d, %s);' % (i, i % 100, self.int_literal()))
+    self.emit(0, 'return total % 1000;')
+    return '\n'.join(self.out) + '\n'
+
+
+def add_arguments(parser):
+  parser.add_argument('--functions', type=int, default=100, help='number of functions')
+  parser.add_argument('--depth', type=int, default=2, help='nesting depth of blocks in a function')
+  parser.add_argument('--loops', type=int, default=1, help='loops per nesting level')
+  parser.add_argument('--structs', type=int, default=10, help='number of struct declarations')
+  parser.add_argument('--literals', type=int, default=3, help='literal statements per innermost block')
+  parser.add_argument('--seed', type=int, default=1)
+
+
+def generate(args):
+  return Generator(args.functions, args.depth, args.loops, args.structs, args.literals,
+                   args.seed).generate()
+
+
+def main():
+  parser = argparse.ArgumentParser(description='Generate a large valid program')
+  add_arguments(parser)
+  parser.add_argument('-o', '--out', help='output path (default: stdout)')
+  args = parser.parse_args()
+  source = generate(args)
+  if args.out:
+    with open(args.out, 'w') as f:
+      f.write(source)
+  else:
+    sys.stdout.write(source)
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -0,0 +1,99 @@
+// Incremental front end benchmark: a digit in the middle of each given file is changed, then the
+// edited source is lexed, parsed and linked from scratch and incrementally (RelexAfterEdit and
+// PerformSyntaxAnalysis with cache of the original source). Both have to give the same RPN.
+
+#include "exceptions.hpp"
+#include "lexical_analyzer.hpp"
+#include "logging.hpp"
+#include "scan.hpp"
+#include "source.hpp"
+#include "syntax_analyzer.hpp"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+double MillisecondsSince(Clock::time_point start) {
+  return static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count()) / 1e3;
+}
+
+std::string Dump(RPN & rpn) {
+  std::string dump;
+  for (const auto & node : rpn.GetNodes())
+    dump += node->ToString() + '\n';
+  return dump;
+}
+
+bool Same(const std::vector<Lexeme> & lhs, const std::vector<Lexeme> & rhs) {
+  if (lhs.size() != rhs.size()) return false;
+  for (size_t i = 0; i < lhs.size(); ++i)
+    if (lhs[i].GetType() != rhs[i].GetType() || lhs[i].GetSymbol() != rhs[i].GetSymbol() ||
+        lhs[i].GetIndex() != rhs[i].GetIndex())
+      return false;
+  return true;
+}
+
+int main(int argc, char * argv[]) {
+  if (argc < 2) {
+    printf("usage: %s <file>...\n", argv[0]);
+    return 1;
+  }
+  bool ok = true;
+  for (int i = 1; i < argc; ++i) {
+    SourceFile source(argv[i]);
+    if (!source.IsOpen()) {
+      printf("%s: cannot open\n", argv[i]);
+      return 1;
+    }
+    std::string_view code = source.GetText();
+    size_t offset = code.size() / 2;
+    // Digit of a numeric literal, so the edited program stays valid
+    while (offset < code.size() && !('0' <= code[offset] && code[offset] <= '8' && !IsIdentifierChar(code[offset - 1])))
+      ++offset;
+    if (offset == code.size()) {
+      printf("%s: no digit to change\n", argv[i]);
+      continue;
+    }
+    TextEdit edit = { offset, 1, std::string(1, static_cast<char>(code[offset] + 1)) };
+    std::string edited(code);
+    edited.replace(edit.offset, edit.removed, edit.inserted);
+
+    try {
+      // Original source fills cache
+      log::init(code, { { "disableWarnings", "true" } });
+      std::vector<Lexeme> lexemes = PerformLexicalAnalysis(code);
+      ParseCache cache;
+      ResetSyntaxAnalysis();
+      Lexer original(lexemes);
+      PerformSyntaxAnalysis(original, &cache);
+      PerformLinking();
+
+      log::init(edited, { { "disableWarnings", "true" } });
+      auto start = Clock::now();
+      ResetSyntaxAnalysis();
+      Lexer full(edited);
+      PerformSyntaxAnalysis(full);
+      RPN full_rpn = PerformLinking();
+      double full_ms = MillisecondsSince(start);
+
+      start = Clock::now();
+      std::vector<Lexeme> relexed = RelexAfterEdit(lexemes, edited, edit);
+      double relex_ms = MillisecondsSince(start);
+      ResetSyntaxAnalysis();
+      Lexer incremental(relexed);
+      PerformSyntaxAnalysis(incremental, &cache);
+      RPN incremental_rpn = PerformLinking();
+      double incremental_ms = MillisecondsSince(start);
+
+      bool same = Dump(full_rpn) == Dump(incremental_rpn) && Same(relexed, PerformLexicalAnalysis(edited));
+      ok &= same;
+      printf("%-32s full %9.2f ms  incremental %9.2f ms (relex %7.2f ms)  functions reused %zu parsed %zu  %s\n",
+             argv[i], full_ms, incremental_ms, relex_ms, cache.reused, cache.parsed, same ? "same" : "DIFFERENT");
+    } catch (const TranslatorError & e) {
+      printf("%-32s %s at %zu\n", argv[i], e.what(), e.GetIndex());
+    }
+  }
+  return ok ? 0 : 1;
+}
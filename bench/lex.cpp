@@ -0,0 +1,59 @@
+// Lexer throughput benchmark: every given file is lexed repeatedly at every scan level
+// supported by CPU and then in parallel, throughput is reported in MB/s of source text.
+
+#include "lexical_analyzer.hpp"
+#include "scan.hpp"
+#include "source.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Each measurement lexes for at least that long
+constexpr uint64_t kTargetNs = 500'000'000;
+
+void Bench(const std::string & path, std::string_view code, ScanLevel level, unsigned threads) {
+  SetScanLevel(level);
+  using Clock = std::chrono::steady_clock;
+  uint64_t runs = 0, ns = 0, best_ns = UINT64_MAX;
+  size_t lexemes = 0;
+  while (ns < kTargetNs) {
+    auto start = Clock::now();
+    lexemes = PerformLexicalAnalysis(code, threads).size();
+    auto run_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    ns += run_ns;
+    best_ns = std::min(best_ns, run_ns);
+    ++runs;
+  }
+  double megabytes = static_cast<double>(code.size()) / 1e6;
+  std::string name = ToString(level) + (threads == 1 ? "" : " x" + std::to_string(threads));
+  printf("%-32s %-12s %10.1f MB/s %10.1f MB/s best %10zu lexemes\n", path.c_str(), name.c_str(),
+         megabytes * static_cast<double>(runs) / (static_cast<double>(ns) / 1e9),
+         megabytes / (static_cast<double>(best_ns) / 1e9), lexemes);
+}
+
+int main(int argc, char * argv[]) {
+  if (argc < 2) {
+    printf("usage: %s <file>...\n", argv[0]);
+    return 1;
+  }
+  std::vector<ScanLevel> levels;
+  for (ScanLevel level : { ScanLevel::kScalar, ScanLevel::kSSE2, ScanLevel::kAVX2 }) {
+    levels.push_back(level);
+    if (level == GetBestScanLevel()) break;
+  }
+  for (int i = 1; i < argc; ++i) {
+    SourceFile source(argv[i]);
+    if (!source.IsOpen()) {
+      printf("%s: cannot open\n", argv[i]);
+      return 1;
+    }
+    for (ScanLevel level : levels)
+      Bench(argv[i], source.GetText(), level, 1);
+    Bench(argv[i], source.GetText(), levels.back(), std::max(1u, std::thread::hardware_concurrency()));
+  }
+  return 0;
+}
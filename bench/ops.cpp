@@ -0,0 +1,254 @@
+// Microbenchmarks of single interpreter operations, driven through run::HandleOperation
+// without going through lexer and parser.
+// Every measured operation includes pushing its operands and popping its result,
+// the same work interpreter does for operands in RPN.
+
+#include "run.hpp"
+#include "TID.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Retired user-space instructions, if perf events are available
+class InstructionCounter {
+ public:
+  InstructionCounter() {
+#ifdef __linux__
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+  }
+  ~InstructionCounter() {
+#ifdef __linux__
+    if (fd_ >= 0) close(fd_);
+#endif
+  }
+
+  bool IsAvailable() const { return fd_ >= 0; }
+
+  void Start() {
+#ifdef __linux__
+    if (fd_ < 0) return;
+    ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+  }
+
+  uint64_t Stop() {
+    uint64_t count = 0;
+#ifdef __linux__
+    if (fd_ < 0) return 0;
+    ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(fd_, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+    return count;
+  }
+
+ private:
+  int fd_ = -1;
+};
+
+InstructionCounter counter;
+std::string filter;
+constexpr uint64_t kTargetNs = 50'000'000;
+
+// Runs body (which performs ops_per_call operations) until kTargetNs is reached
+void Bench(const std::string & name, uint64_t ops_per_call, const std::function<void()> & body) {
+  if (!filter.empty() && name.find(filter) == std::string::npos) return;
+  using Clock = std::chrono::steady_clock;
+  uint64_t iterations = 1;
+  uint64_t best_ns = 0, best_instructions = 0, ops = 0;
+  while (true) {
+    counter.Start();
+    auto start = Clock::now();
+    for (uint64_t i = 0; i < iterations; ++i)
+      body();
+    auto ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    auto instructions = counter.Stop();
+    if (ns >= kTargetNs / 10) {
+      ops = iterations * ops_per_call;
+      best_ns = ns;
+      best_instructions = instructions;
+      if (ns >= kTargetNs) break;
+    }
+    iterations *= 2;
+  }
+  double ns_per_op = static_cast<double>(best_ns) / static_cast<double>(ops);
+  if (counter.IsAvailable())
+    printf("%-32s %10.2f ns/op %10.1f instr/op\n", name.c_str(), ns_per_op,
+           static_cast<double>(best_instructions) / static_cast<double>(ops));
+  else
+    printf("%-32s %10.2f ns/op %10s instr/op\n", name.c_str(), ns_per_op, "-");
+}
+
+std::string Name(PrimitiveVariableType type) {
+  return ToString(type);
+}
+
+std::string Name(RPNOperatorType op) {
+  return ToString(op);
+}
+
+uint64_t Value(PrimitiveVariableType type, double value) {
+  if (type == PrimitiveVariableType::kF64) {
+    uint64_t result;
+    memcpy(&result, &value, sizeof(result));
+    return result;
+  }
+  if (type == PrimitiveVariableType::kF32) {
+    float value_f = static_cast<float>(value);
+    uint32_t result;
+    memcpy(&result, &value_f, sizeof(result));
+    return result;
+  }
+  return static_cast<uint64_t>(value);
+}
+
+const PrimitiveVariableType numeric_types[] = {
+  PrimitiveVariableType::kInt8, PrimitiveVariableType::kInt16, PrimitiveVariableType::kInt32,
+  PrimitiveVariableType::kInt64, PrimitiveVariableType::kUint8, PrimitiveVariableType::kUint16,
+  PrimitiveVariableType::kUint32, PrimitiveVariableType::kUint64, PrimitiveVariableType::kF32,
+  PrimitiveVariableType::kF64
+};
+
+void BenchMemory() {
+  const uint64_t address = 4096;
+  for (auto type : { PrimitiveVariableType::kUint8, PrimitiveVariableType::kUint16,
+                     PrimitiveVariableType::kUint32, PrimitiveVariableType::kUint64 }) {
+    Bench("kLoad " + Name(type), 1, [&]() {
+      run::Push(address);
+      run::HandleOperation(RPNOperatorType::kLoad, type);
+      run::Pop();
+    });
+    Bench("kStoreDA " + Name(type), 1, [&]() {
+      run::Push(42);
+      run::Push(address);
+      run::HandleOperation(RPNOperatorType::kStoreDA, type);
+    });
+  }
+  for (uint64_t size : { 8, 64, 512, 4096, 65536 }) {
+    Bench("kCopyFT " + std::to_string(size), 1, [&]() {
+      run::Push(address);
+      run::Push(address + size);
+      run::Push(size);
+      run::HandleOperation(RPNOperatorType::kCopyFT, PrimitiveVariableType::kUnknown);
+    });
+    Bench("kFill " + std::to_string(size), 1, [&]() {
+      run::Push(address);
+      run::Push(size);
+      run::HandleOperation(RPNOperatorType::kFill, PrimitiveVariableType::kUnknown);
+    });
+  }
+}
+
+void BenchArithmetic() {
+  const RPNOperatorType binary[] = {
+    RPNOperatorType::kAdd, RPNOperatorType::kSubtract, RPNOperatorType::kMultiply,
+    RPNOperatorType::kDivide, RPNOperatorType::kModulus, RPNOperatorType::kLess,
+    RPNOperatorType::kEqual
+  };
+  for (auto op : binary) {
+    for (auto type : numeric_types) {
+      uint64_t lhs = Value(type, 117), rhs = Value(type, 7);
+      Bench(Name(op) + " " + Name(type), 1, [&]() {
+        run::Push(lhs);
+        run::Push(rhs);
+        run::HandleOperation(op, type);
+        run::Pop();
+      });
+    }
+  }
+  const RPNOperatorType bitwise[] = {
+    RPNOperatorType::kBitwiseShiftLeft, RPNOperatorType::kBitwiseShiftRight, RPNOperatorType::kBitwiseAnd,
+    RPNOperatorType::kBitwiseOr, RPNOperatorType::kBitwiseXor, RPNOperatorType::kRotateLeft
+  };
+  for (auto op : bitwise) {
+    for (auto type : { PrimitiveVariableType::kInt32, PrimitiveVariableType::kUint64 }) {
+      Bench(Name(op) + " " + Name(type), 1, [&]() {
+        run::Push(117);
+        run::Push(3);
+        run::HandleOperation(op, type);
+        run::Pop();
+      });
+    }
+  }
+  for (auto type : { PrimitiveVariableType::kInt32, PrimitiveVariableType::kF64 }) {
+    uint64_t value = Value(type, 117);
+    Bench(Name(RPNOperatorType::kMinus) + " " + Name(type), 1, [&]() {
+      run::Push(value);
+      run::HandleOperation(RPNOperatorType::kMinus, type);
+      run::Pop();
+    });
+    Bench(Name(RPNOperatorType::kToF64) + " " + Name(type), 1, [&]() {
+      run::Push(value);
+      run::HandleOperation(RPNOperatorType::kToF64, type);
+      run::Pop();
+    });
+  }
+}
+
+void BenchHeap() {
+  for (uint64_t size : { 16, 256, 4096 }) {
+    // Heap is never reused, so pointer is moved back after every deletion
+    Bench("kNew+kDelete " + std::to_string(size), 2, [&]() {
+      run::Push(size);
+      run::HandleOperation(RPNOperatorType::kNew, PrimitiveVariableType::kUnknown);
+      run::Push(size);
+      run::HandleOperation(RPNOperatorType::kDelete, PrimitiveVariableType::kUnknown);
+      run::hp = run::STACK_SIZE;
+    });
+  }
+}
+
+void BenchCall() {
+  const uint64_t function_pc = 100;
+  const uint64_t frame_size = 32;
+  // Global frame, as pushed by the beginning of every program
+  run::Push(64);
+  run::Push(0);
+  run::HandleOperation(RPNOperatorType::kPush, PrimitiveVariableType::kUnknown);
+  // Same sequence as generated for a call of function without parameters:
+  // push frame, store return address, call, return, pop frame
+  Bench("kCall+kReturn round trip", 1, [&]() {
+    run::Push(frame_size);
+    run::Push(function_pc);
+    run::HandleOperation(RPNOperatorType::kPush, PrimitiveVariableType::kUnknown);
+    run::Push(50);
+    run::Push(0);
+    run::HandleOperation(RPNOperatorType::kFromSP, PrimitiveVariableType::kUnknown);
+    run::HandleOperation(RPNOperatorType::kStoreDA, PrimitiveVariableType::kUint64);
+    run::Push(function_pc);
+    run::HandleOperation(RPNOperatorType::kCall, PrimitiveVariableType::kUnknown);
+    run::HandleOperation(RPNOperatorType::kReturn, PrimitiveVariableType::kUnknown);
+    run::HandleOperation(RPNOperatorType::kPop, PrimitiveVariableType::kUnknown);
+  });
+}
+
+int main(int argc, char * argv[]) {
+  if (argc > 1) filter = argv[1];
+  run::Reset();
+  run::program_size = 1000;
+  if (!counter.IsAvailable())
+    printf("perf events are not available, instructions are not counted\n");
+  BenchMemory();
+  BenchArithmetic();
+  BenchHeap();
+  BenchCall();
+  return 0;
+}
@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+# Runs every workload in bench/workloads N times and reports per-phase timings.
+#
+# Each workload is <name>.txt with the expected stdout in <name>.expected and
+# optional stdin in <name>.input. The binary is run with --quiet --timings and
+# prints "timing <phase> <ns>" lines to stderr, which are collected here.
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import time
+
+ROOT = os.path.dirname(os.path.abspath(__file__))
+WORKLOADS = os.path.join(ROOT, 'workloads')
+PHASES = ['lex', 'parse', 'link', 'exec']
+
+
+def percentile(values, p):
+  values = sorted(values)
+  if not values:
+    return 0
+  k = (len(values) - 1) * p / 100
+  lo = int(k)
+  hi = min(lo + 1, len(values) - 1)
+  return values[lo] + (values[hi] - values[lo]) * (k - lo)
+
+
+def run_once(binary, workload, stdin_data):
+  proc = subprocess.run([binary, '-c', workload, '-q', '--timings', '--disableWarnings'],
+                        input=stdin_data, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+  timings = {}
+  for line in proc.stderr.decode(errors='replace').splitlines():
+    parts = line.split()
+    if len(parts) == 3 and parts[0] == 'timing':
+      timings[parts[1]] = int(parts[2])
+  return proc.returncode, proc.stdout, timings
+
+
+def run_workload(binary, name, runs):
+  workload = os.path.join(WORKLOADS, name + '.txt')
+  stdin_data = b''
+  input_path = os.path.join(WORKLOADS, name + '.input')
+  if os.path.exists(input_path):
+    with open(input_path, 'rb') as f:
+      stdin_data = f.read()
+  with open(os.path.join(WORKLOADS, name + '.expected'), 'rb') as f:
+    expected = f.read()
+
+  samples = {phase: [] for phase in PHASES}
+  for _ in range(runs):
+    code, out, timings = run_once(binary, workload, stdin_data)
+    if code != 0 or out != expected:
+      sys.stderr.write('%s: unexpected output (exit code %d)\n' % (name, code))
+      return None
+    for phase in PHASES:
+      if phase in timings:
+        samples[phase].append(timings[phase])
+
+  # Phase not reported by the binary is left out rather than recorded as zero
+  result = {}
+  for phase in PHASES:
+    if len(samples[phase]) != runs:
+      continue
+    result[phase] = {
+      'median_ms': percentile(samples[phase], 50) / 1e6,
+      'p95_ms': percentile(samples[phase], 95) / 1e6,
+    }
+  return result
+
+
+def commit_hash():
+  try:
+    return subprocess.check_output(['git', 'rev-parse', '--short', 'HEAD'], cwd=ROOT,
+                                   stderr=subprocess.DEVNULL).decode().strip()
+  except (OSError, subprocess.CalledProcessError):
+    return 'unknown'
+
+
+def print_table(results, baseline):
+  header = '%-12s' % 'workload'
+  for phase in PHASES:
+    header += ' %12s %12s' % (phase + ' med', phase + ' p95')
+  print(header)
+  for name, phases in results.items():
+    row = '%-12s' % name
+    for phase in PHASES:
+      if phase in phases:
+        row += ' %12.3f %12.3f' % (phases[phase]['median_ms'], phases[phase]['p95_ms'])
+      else:
+        row += ' %12s %12s' % ('-', '-')
+    print(row)
+    if baseline and name in baseline:
+      row = '%-12s' % '  vs base'
+      for phase in PHASES:
+        old = baseline[name].get(phase, {}).get('median_ms', 0)
+        new = phases.get(phase, {}).get('median_ms', 0)
+        delta = (new - old) / old * 100 if old else 0
+        row += ' %+11.1f%% %12s' % (delta, '')
+      print(row)
+
+
+def main():
+  parser = argparse.ArgumentParser(description='Run translator benchmarks')
+  parser.add_argument('--bin', default=os.path.join(ROOT, '..', 'bin', 'app-bench'))
+  parser.add_argument('--runs', type=int, default=10)
+  parser.add_argument('--out', help='write JSON results to this path')
+  parser.add_argument('--compare', help='JSON results of a previous run to compare against')
+  parser.add_argument('workloads', nargs='*', help='workload names (default: all)')
+  args = parser.parse_args()
+
+  names = args.workloads or sorted(f[:-4] for f in os.listdir(WORKLOADS) if f.endswith('.txt'))
+  results = {}
+  failed = False
+  for name in names:
+    result = run_workload(args.bin, name, args.runs)
+    if result is None:
+      failed = True
+    else:
+      results[name] = result
+
+  baseline = None
+  if args.compare:
+    with open(args.compare) as f:
+      baseline = json.load(f)['workloads']
+  print_table(results, baseline)
+
+  if args.out:
+    os.makedirs(os.path.dirname(os.path.abspath(args.out)), exist_ok=True)
+    with open(args.out, 'w') as f:
+      json.dump({
+        'commit': commit_hash(),
+        'date': time.strftime('%Y-%m-%dT%H:%M:%S'),
+        'runs': args.runs,
+        'workloads': results,
+      }, f, indent=2)
+  return 1 if failed else 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+# Compiler scalability benchmark: generates programs of growing size with
+# bench/gen.py and records lex/parse/link time and peak memory for each.
+#
+# For every phase the growth exponent between consecutive sizes is printed
+# (time ~ size^k); anything noticeably above 1 is marked as super-linear.
+# With --plot and matplotlib available a log-log chart is written as well.
+
+import argparse
+import json
+import math
+import os
+import subprocess
+import sys
+import tempfile
+
+import gen
+
+ROOT = os.path.dirname(os.path.abspath(__file__))
+PHASES = ['lex', 'parse', 'link']
+SUPERLINEAR = 1.3
+
+
+def measure(binary, path):
+  proc = subprocess.Popen([binary, '-c', path, '-q', '--timings', '--disableWarnings'],
+                          stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+  stderr = proc.stderr.read()
+  _, status, usage = os.wait4(proc.pid, 0)
+  proc.returncode = os.waitstatus_to_exitcode(status)
+  timings = {}
+  for line in stderr.decode(errors='replace').splitlines():
+    parts = line.split()
+    if len(parts) == 3 and parts[0] == 'timing':
+      timings[parts[1]] = int(parts[2])
+  # ru_maxrss is in kilobytes on Linux
+  return proc.returncode, timings, usage.ru_maxrss
+
+
+def exponent(x0, y0, x1, y1):
+  if x0 <= 0 or x1 <= x0 or y0 <= 0 or y1 <= 0:
+    return 0
+  return math.log(y1 / y0) / math.log(x1 / x0)
+
+
+def plot(points, path):
+  try:
+    import matplotlib
+    matplotlib.use('Agg')
+    import matplotlib.pyplot as plt
+  except ImportError:
+    sys.stderr.write('matplotlib is not available, skipping plot\n')
+    return
+  sizes = [p['lines'] for p in points]
+  fig, (time_ax, mem_ax) = plt.subplots(1, 2, figsize=(12, 5))
+  for phase in PHASES:
+    time_ax.loglog(sizes, [p[phase + '_ms'] for p in points], marker='o', label=phase)
+  time_ax.set_xlabel('lines')
+  time_ax.set_ylabel('ms')
+  time_ax.legend()
+  mem_ax.loglog(sizes, [p['peak_kb'] for p in points], marker='o')
+  mem_ax.set_xlabel('lines')
+  mem_ax.set_ylabel('peak RSS, KB')
+  fig.tight_layout()
+  fig.savefig(path)
+
+
+def main():
+  parser = argparse.ArgumentParser(description='Measure compile time against program size')
+  gen.add_arguments(parser)
+  parser.add_argument('--bin', default=os.path.join(ROOT, '..', 'bin', 'app-bench'))
+  parser.add_argument('--sizes', default='250,500,1000,2000,4000',
+                      help='comma-separated numbers of functions')
+  parser.add_argument('--runs', type=int, default=3, help='runs per size, the fastest is kept')
+  parser.add_argument('--out', help='write JSON results to this path')
+  parser.add_argument('--plot', help='write a log-log chart (PNG) to this path')
+  args = parser.parse_args()
+
+  points = []
+  with tempfile.TemporaryDirectory() as tmp:
+    for functions in [int(x) for x in args.sizes.split(',')]:
+      args.functions = functions
+      source = gen.generate(args)
+      path = os.path.join(tmp, 'gen_%d.txt' % functions)
+      with open(path, 'w') as f:
+        f.write(source)
+      point = {'functions': functions, 'lines': source.count('\n'), 'bytes': len(source)}
+      best = {}
+      peak = 0
+      for _ in range(args.runs):
+        code, timings, peak_kb = measure(args.bin, path)
+        if code != 0:
+          sys.stderr.write('%d functions: exit code %d\n' % (functions, code))
+          return 1
+        for phase in PHASES:
+          best[phase] = min(best.get(phase, timings.get(phase, 0)), timings.get(phase, 0))
+        peak = max(peak, peak_kb)
+      for phase in PHASES:
+        point[phase + '_ms'] = best[phase] / 1e6
+      point['peak_kb'] = peak
+      points.append(point)
+
+  header = '%10s %10s' % ('functions', 'lines')
+  for phase in PHASES:
+    header += ' %11s %6s' % (phase + ' ms', 'k')
+  header += ' %10s %6s' % ('peak KB', 'k')
+  print(header)
+  flagged = set()
+  for i, point in enumerate(points):
+    row = '%10d %10d' % (point['functions'], point['lines'])
+    for key in [phase + '_ms' for phase in PHASES] + ['peak_kb']:
+      k = ''
+      if i > 0:
+        value = exponent(points[i - 1]['lines'], points[i - 1][key], point['lines'], point[key])
+        k = '%.2f' % value
+        if value > SUPERLINEAR:
+          k += '!'
+          flagged.add(key)
+      width = 10 if key == 'peak_kb' else 11
+      fmt = ' %' + str(width) + ('d' if key == 'peak_kb' else '.3f') + ' %6s'
+      row += fmt % (point[key], k)
+    print(row)
+  for key in sorted(flagged):
+    print('super-linear growth: %s' % key)
+
+  if args.out:
+    with open(args.out, 'w') as f:
+      json.dump({'points': points}, f, indent=2)
+  if args.plot:
+    plot(points, args.plot)
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
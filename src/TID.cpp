@@ -29,47 +29,47 @@ uint32_t GetSizeOfPrimitive(const PrimitiveVariableType & type) {
   }
 }
 
-std::wstring names[kPrimitiveVariableTypeCount];
-std::map<std::wstring, PrimitiveVariableType> dict;
+std::string names[kPrimitiveVariableTypeCount];
+std::map<std::string, PrimitiveVariableType> dict;
 void SetUpNames() {
   static bool set_up = false;
   if (set_up) return;
 #define Set(key, value) names[static_cast<uint8_t>(PrimitiveVariableType::key)] = value; \
   dict[value] = PrimitiveVariableType::key
-  Set(kInt8, L"int8");
-  Set(kInt16, L"int16");
-  Set(kInt32, L"int32");
-  Set(kInt64, L"int64");
-  Set(kUint8, L"uint8");
-  Set(kUint16, L"uint16");
-  Set(kUint32, L"uint32");
-  Set(kUint64, L"uint64");
-  Set(kChar, L"char");
-  Set(kBool, L"bool");
-  Set(kF32, L"f32");
-  Set(kF64, L"f64");
+  Set(kInt8, "int8");
+  Set(kInt16, "int16");
+  Set(kInt32, "int32");
+  Set(kInt64, "int64");
+  Set(kUint8, "uint8");
+  Set(kUint16, "uint16");
+  Set(kUint32, "uint32");
+  Set(kUint64, "uint64");
+  Set(kChar, "char");
+  Set(kBool, "bool");
+  Set(kF32, "f32");
+  Set(kF64, "f64");
 #undef Set
   set_up = true;
 }
 
-std::wstring ToString(PrimitiveVariableType type) {
+std::string ToString(PrimitiveVariableType type) {
   SetUpNames();
   return names[static_cast<uint8_t>(type)];
 }
 
-PrimitiveVariableType FromWstringToPrimitiveType(const std::wstring & str) {
+PrimitiveVariableType FromWstringToPrimitiveType(const std::string & str) {
   SetUpNames();
   if (dict.count(str)) return dict[str];
   else return PrimitiveVariableType::kUnknown;
 }
 
-std::shared_ptr<TIDVariableType> TIDComplexVariableType::GetField(std::wstring & name) const {
+std::shared_ptr<TIDVariableType> TIDComplexVariableType::GetField(std::string & name) const {
   for (auto [field_name, value] : contents_)
     if (field_name == name)
       return value;
   return { };
 }
-uint32_t TIDComplexVariableType::GetOffset(std::wstring & name) const {
+uint32_t TIDComplexVariableType::GetOffset(std::string & name) const {
   uint32_t offset = 0;
   for (auto [field_name, value] : contents_) {
     if (field_name == name)
@@ -79,60 +79,60 @@ uint32_t TIDComplexVariableType::GetOffset(std::wstring & name) const {
   return offset;
 }
 
-std::wstring TIDPrimitiveVariableType::ToString() const {
-  std::wstring result;
-  if (IsConst()) result += L"const ";
+std::string TIDPrimitiveVariableType::ToString() const {
+  std::string result;
+  if (IsConst()) result += "const ";
   result += ::ToString(type_);
-  if (IsReference()) result += L" &";
+  if (IsReference()) result += " &";
   return result;
 }
 
-std::wstring TIDComplexVariableType::ToString() const {
-  std::wstring result;
-  if (IsConst()) result += L"const ";
+std::string TIDComplexVariableType::ToString() const {
+  std::string result;
+  if (IsConst()) result += "const ";
   result += name_;
-  if (IsReference()) result += L" &";
+  if (IsReference()) result += " &";
   return result;
 }
 
-std::wstring TIDFunctionVariableType::ToString() const {
-  std::wstring result;
-  if (IsConst()) result += L"const ";
-  result += L"function<" + (return_type_ ? return_type_->ToString() : L"void") + L"(";
+std::string TIDFunctionVariableType::ToString() const {
+  std::string result;
+  if (IsConst()) result += "const ";
+  result += "function<" + (return_type_ ? return_type_->ToString() : "void") + "(";
   bool was_first = false;
   if (!parameters_.empty()) {
     result += parameters_[0]->ToString();
     was_first = true;
     for (size_t i = 1; i < parameters_.size(); ++i)
-      result += L", " + parameters_[i]->ToString();
+      result += ", " + parameters_[i]->ToString();
   }
   if (!default_parameters_.empty()) {
     if (!was_first)
-      result += default_parameters_[0]->ToString() + L"=";
+      result += default_parameters_[0]->ToString() + "=";
     for (size_t i = !was_first; i < default_parameters_.size(); ++i)
-      result += L", " + default_parameters_[i]->ToString() + L"=";
+      result += ", " + default_parameters_[i]->ToString() + "=";
   }
-  result += L")>";
-  if (IsReference()) result += L" &";
+  result += ")>";
+  if (IsReference()) result += " &";
   return result;
 }
 
-std::wstring TIDPointerVariableType::ToString() const {
-  std::wstring result;
-  if (IsConst()) result += L"const ";
+std::string TIDPointerVariableType::ToString() const {
+  std::string result;
+  if (IsConst()) result += "const ";
   if (value_->GetType() == VariableType::kArray)
-    result += L"*(" + value_->ToString() + L")";
+    result += "*(" + value_->ToString() + ")";
   else
-    result += L"*" + value_->ToString();
-  if (IsReference()) result += L" &";
+    result += "*" + value_->ToString();
+  if (IsReference()) result += " &";
   return result;
 }
 
-std::wstring TIDArrayVariableType::ToString() const {
-  std::wstring result;
-  if (IsConst()) result += L"const ";
-  result += value_->ToString() + L"[]";
-  if (IsReference()) result += L" &";
+std::string TIDArrayVariableType::ToString() const {
+  std::string result;
+  if (IsConst()) result += "const ";
+  result += value_->ToString() + "[]";
+  if (IsReference()) result += " &";
   return result;
 }
 
@@ -251,10 +251,10 @@ std::vector<std::shared_ptr<TIDValue>> GetDerivedTypes(const std::shared_ptr<TID
   return result;
 }
 
-void TID::LoadVariableAddress(const std::wstring & name, RPN & rpn) const {
+void TID::LoadVariableAddress(const std::string & name, RPN & rpn) const {
   for (size_t i = nodes_.size() - 1; ~i; --i) {
     if (nodes_[i].variables_.count(name)) {
-      rpn.PushNode(RPNOperand(nodes_.back().variables_.at(name)->GetAddress()));
+      rpn.PushNode(RPNOperand(nodes_[i].variables_.at(name)->GetAddress()));
       if (nodes_[i].func_name == nodes_.back().func_name) {
         rpn.PushNode(RPNOperator(RPNOperatorType::kFromSP));
       } else {
@@ -271,9 +271,10 @@ void TID::LoadVariableAddress(const std::wstring & name, RPN & rpn) const {
 void TID::AddScope() {
   nodes_.emplace_back();
   nodes_.back().next_address_ = nodes_[nodes_.size() - 2].next_address_;
+  nodes_.back().func_name = nodes_[nodes_.size() - 2].func_name;
 }
 
-void TID::AddFunctionScope(const std::wstring & name, const std::shared_ptr<TIDVariableType> & return_type) {
+void TID::AddFunctionScope(const std::string & name, const std::shared_ptr<TIDVariableType> & return_type) {
   nodes_.emplace_back();
   nodes_.back().func_name = name;
   uint32_t size_for_return = return_type ? return_type->GetSize() + 1 : 0;
@@ -296,7 +297,7 @@ void TID::RemoveFunctionScope() {
 void TID::AddComplexStruct(const Lexeme & lexeme, const std::shared_ptr<TIDVariableType> & complex_struct) {
   if (!complex_struct || complex_struct->GetType() != VariableType::kComplex)
     throw NotComplexStructError();
-  std::wstring name = std::static_pointer_cast<TIDComplexVariableType>(complex_struct)->GetName();
+  std::string name = std::static_pointer_cast<TIDComplexVariableType>(complex_struct)->GetName();
   if (nodes_.back().complex_structs_.count(name) || nodes_.back().variables_.count(name))
     throw ConflictingNames(lexeme);
   std::dynamic_pointer_cast<TIDComplexVariableType>(complex_struct)
@@ -304,7 +305,7 @@ void TID::AddComplexStruct(const Lexeme & lexeme, const std::shared_ptr<TIDVaria
   nodes_.back().complex_structs_[name] = complex_struct;
 }
 
-void TID::AddVariable(const Lexeme & lexeme, const std::wstring & name,
+void TID::AddVariable(const Lexeme & lexeme, const std::string & name,
     const std::shared_ptr<TIDVariableType> & type) {
   if (!type)
     throw VoidNotExpected(lexeme);
@@ -320,7 +321,7 @@ uint64_t TID::AddTemporaryInstance([[maybe_unused]] const Lexeme & lexeme,
                                      const std::shared_ptr<TIDVariableType> & type) {
   if (!type)
     throw VoidNotExpected(lexeme);
-  std::wstring name = L"$" + std::to_wstring(temp_structs++);
+  std::string name = "$" + std::to_string(temp_structs++);
   std::shared_ptr<TIDVariable> var = std::make_shared<TIDVariable>(name, GetCurrentPrefix(), type,
       nodes_.back().next_address_);
   nodes_.back().next_address_ += type->GetSize();
@@ -328,9 +329,9 @@ uint64_t TID::AddTemporaryInstance([[maybe_unused]] const Lexeme & lexeme,
   return nodes_.back().next_address_ - type->GetSize();
 }
 
-std::wstring TID::GetCurrentPrefix() const {
-  std::wstring ans;
+std::string TID::GetCurrentPrefix() const {
+  std::string ans;
   for (const TIDNode & node : nodes_)
-    ans += std::to_wstring(node.child_node_cnt_) + L"::";
+    ans += std::to_string(node.child_node_cnt_) + "::";
   return ans;
 }
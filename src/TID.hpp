@@ -1,11 +1,13 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <stdexcept>
 #include <string>
 #include <vector>
 #include <map>
 #include "lexeme.hpp"
+#include "primitive_type.hpp"
 
 enum class VariableType : uint8_t {
   kPrimitive, kComplex, kFunction, kPointer, kArray
@@ -22,7 +24,7 @@ class TIDVariableType {
   void SetConst(bool val) { const_ = val; }
   void SetReference(bool val) { ref_ = val; }
 
-  virtual std::wstring ToString() const = 0;
+  virtual std::string ToString() const = 0;
 
  protected:
   TIDVariableType(VariableType type, uint32_t size)
@@ -35,14 +37,6 @@ class TIDVariableType {
   bool const_, ref_;
 };
 
-// if you change this list you need to change another few
-// parameters in operators.cpp in casting section
-constexpr uint8_t kPrimitiveVariableTypeCount = 13;
-enum class PrimitiveVariableType : uint8_t {
-  kInt8 = 0, kInt16 = 1, kInt32 = 2, kInt64 = 3,
-  kUint8 = 4, kUint16 = 5, kUint32 = 6, kUint64 = 7,
-  kF32 = 8, kF64 = 9, kBool = 10, kChar = 11, kUnknown = 12
-};
 constexpr PrimitiveVariableType types[] = {
   PrimitiveVariableType::kInt8, PrimitiveVariableType::kInt16, PrimitiveVariableType::kInt32,
   PrimitiveVariableType::kInt64, PrimitiveVariableType::kUint8, PrimitiveVariableType::kUint16,
@@ -51,8 +45,8 @@ constexpr PrimitiveVariableType types[] = {
 };
 
 uint32_t GetSizeOfPrimitive(const PrimitiveVariableType & type);
-std::wstring ToString(PrimitiveVariableType type);
-PrimitiveVariableType FromWstringToPrimitiveType(const std::wstring & str);
+std::string ToString(PrimitiveVariableType type);
+PrimitiveVariableType FromWstringToPrimitiveType(const std::string & str);
 
 class TIDPrimitiveVariableType : public TIDVariableType {
  private:
@@ -64,7 +58,7 @@ class TIDPrimitiveVariableType : public TIDVariableType {
 
   PrimitiveVariableType GetPrimitiveType() const { return type_; }
 
-  std::wstring ToString() const override;
+  std::string ToString() const override;
 
  private:
   friend std::shared_ptr<TIDVariableType> GetPrimitiveVariableType(PrimitiveVariableType);
@@ -75,7 +69,7 @@ class TIDPrimitiveVariableType : public TIDVariableType {
 
 class TIDComplexVariableType : public TIDVariableType {
  public:
-  TIDComplexVariableType(const std::wstring & name, const std::vector<std::pair<std::wstring, std::shared_ptr<TIDVariableType>>> & contents)
+  TIDComplexVariableType(const std::string & name, const std::vector<std::pair<std::string, std::shared_ptr<TIDVariableType>>> & contents)
     : TIDVariableType(VariableType::kComplex, 0), name_(name), contents_(contents) {
     uint32_t our_size = 0;
     for (const auto & [field_name, type] : contents_)
@@ -83,25 +77,25 @@ class TIDComplexVariableType : public TIDVariableType {
     SetSize(our_size);
   }
 
-  const std::vector<std::pair<std::wstring, std::shared_ptr<TIDVariableType>>> & GetContents() const { return contents_; }
+  const std::vector<std::pair<std::string, std::shared_ptr<TIDVariableType>>> & GetContents() const { return contents_; }
 
-  std::wstring GetName() const { return name_; }
-  std::wstring GetInternalName() const { return internal_name_; }
-  std::shared_ptr<TIDVariableType> GetField(std::wstring & name) const;
-  uint32_t GetOffset(std::wstring & name) const;
+  std::string GetName() const { return name_; }
+  std::string GetInternalName() const { return internal_name_; }
+  std::shared_ptr<TIDVariableType> GetField(std::string & name) const;
+  uint32_t GetOffset(std::string & name) const;
 
-  std::wstring ToString() const override;
+  std::string ToString() const override;
 
  private:
   friend class TID;
-  void SetInternalPrefix(const std::wstring & prefix) {
+  void SetInternalPrefix(const std::string & prefix) {
     internal_name_ = prefix + name_;
   }
 
  private:
-  std::wstring name_;
-  std::wstring internal_name_;
-  std::vector<std::pair<std::wstring, std::shared_ptr<TIDVariableType>>> contents_;
+  std::string name_;
+  std::string internal_name_;
+  std::vector<std::pair<std::string, std::shared_ptr<TIDVariableType>>> contents_;
 };
 
 class TIDFunctionVariableType : public TIDVariableType {
@@ -116,7 +110,7 @@ class TIDFunctionVariableType : public TIDVariableType {
   const std::vector<std::shared_ptr<TIDVariableType>> & GetParameters() const { return parameters_; }
   const std::vector<std::shared_ptr<TIDVariableType>> & GetDefaultParameters() const { return default_parameters_; }
 
-  std::wstring ToString() const override;
+  std::string ToString() const override;
 
  private:
   std::shared_ptr<TIDVariableType> return_type_;
@@ -132,7 +126,7 @@ class TIDPointerVariableType : public TIDVariableType {
     : TIDVariableType(VariableType::kPointer, 8), value_(pointing_to) {}
   std::shared_ptr<TIDVariableType> GetValue() const { return value_; }
 
-  std::wstring ToString() const override;
+  std::string ToString() const override;
 
  private:
   friend std::shared_ptr<TIDVariableType> DerivePointerFromType(const std::shared_ptr<TIDVariableType> & type);
@@ -150,7 +144,7 @@ class TIDArrayVariableType : public TIDVariableType {
       : TIDVariableType(VariableType::kArray, 8), value_(value) {}
   std::shared_ptr<TIDVariableType> GetValue() const { return value_; }
 
-  std::wstring ToString() const override;
+  std::string ToString() const override;
 
   private:
   friend std::shared_ptr<TIDVariableType> DeriveArrayFromType(const std::shared_ptr<TIDVariableType> & type);
@@ -179,7 +173,7 @@ class TIDValue {
   TIDValueType GetValueType() const { return value_type_; }
   std::shared_ptr<TIDVariableType> GetType() const { return type_; }
 
-  virtual std::wstring ToString() const = 0;
+  virtual std::string ToString() const = 0;
 
  protected:
   TIDValue(TIDValueType value_type, const std::shared_ptr<TIDVariableType> & type)
@@ -194,29 +188,29 @@ class TIDTemporaryValue : public TIDValue {
  public:
   TIDTemporaryValue(const std::shared_ptr<TIDVariableType> & type) : TIDValue(TIDValueType::kTemporary, type) {}
 
-  std::wstring ToString() const override {
+  std::string ToString() const override {
     auto type = GetType();
-    return type ? type->ToString() : L"void";
+    return type ? type->ToString() : "void";
   }
 };
 
 class TIDVariable : public TIDValue {
  public:
-  TIDVariable(const std::wstring & name, const std::wstring & internal_prefix, const std::shared_ptr<TIDVariableType> & type, uint32_t address)
+  TIDVariable(const std::string & name, const std::string & internal_prefix, const std::shared_ptr<TIDVariableType> & type, uint32_t address)
              : TIDValue(TIDValueType::kVariable, type), name_(name), internal_name_(internal_prefix + name), address_(address) {}
 
-  std::wstring GetName() const { return name_; }
-  std::wstring GetInternalName() const { return internal_name_; }
+  std::string GetName() const { return name_; }
+  std::string GetInternalName() const { return internal_name_; }
   uint64_t GetAddress() const { return address_; }
 
-  std::wstring ToString() const override {
+  std::string ToString() const override {
     auto type = GetType();
-    return name_ + L": " + (type ? type->ToString() : L"void");
+    return name_ + ": " + (type ? type->ToString() : "void");
   }
 
  private:
-  std::wstring name_;
-  std::wstring internal_name_;
+  std::string name_;
+  std::string internal_name_;
   uint64_t address_;
 };
 
@@ -227,54 +221,58 @@ class RPN;
 class TID {
  public:
   TID() {
-    AddFunctionScope(L"$global", SetConstToType(
+    AddFunctionScope("$global", SetConstToType(
       GetPrimitiveVariableType(PrimitiveVariableType::kInt32), true
     ));
   }
 
   // All of them will return nullptr in std::shared_ptr if complex struct/variable is not found
-  std::shared_ptr<const TIDVariableType> GetComplexStruct(const std::wstring & name) const {
+  std::shared_ptr<const TIDVariableType> GetComplexStruct(const std::string & name) const {
     for (size_t scope_index = nodes_.size() - 1; ~scope_index; --scope_index)
       if (nodes_[scope_index].complex_structs_.count(name))
         return nodes_[scope_index].complex_structs_.at(name);
     // Not found, returning empty pointer
     return {};
   }
-  std::shared_ptr<TIDVariableType> GetComplexStruct(const std::wstring & name) {
+  std::shared_ptr<TIDVariableType> GetComplexStruct(const std::string & name) {
     return std::const_pointer_cast<TIDVariableType>(const_cast<const TID &>(*this).GetComplexStruct(name));
   }
 
-  std::shared_ptr<const TIDVariable> GetVariable(const std::wstring & name) const {
+  std::shared_ptr<const TIDVariable> GetVariable(const std::string & name) const {
     for (size_t scope_index = nodes_.size() - 1; ~scope_index; --scope_index)
       if (nodes_[scope_index].variables_.count(name))
         return nodes_[scope_index].variables_.at(name);
     // Not found, returning empty variable
     return {};
   }
-  std::shared_ptr<TIDVariable> GetVariable(const std::wstring & name) {
+  std::shared_ptr<TIDVariable> GetVariable(const std::string & name) {
     return std::const_pointer_cast<TIDVariable>(const_cast<const TID &>(*this).GetVariable(name));
   }
 
-  std::shared_ptr<const TIDVariable> GetVariableFromCurrentScope(const std::wstring & name) const {
+  std::shared_ptr<const TIDVariable> GetVariableFromCurrentScope(const std::string & name) const {
     const auto & vars = nodes_.back().variables_;
     return vars.count(name) ? vars.at(name) : nullptr;
   }
-  std::shared_ptr<TIDVariable> GetVariableFromCurrentScope(const std::wstring & name) {
+  std::shared_ptr<TIDVariable> GetVariableFromCurrentScope(const std::string & name) {
     return std::const_pointer_cast<TIDVariable>(const_cast<const TID &>(*this).GetVariableFromCurrentScope(name));
   }
 
   uint64_t GetFunctionScopeMaxAddress() const { return max_address_.back(); }
 
+  // In order of declaration (by address)
   std::vector<std::shared_ptr<TIDVariable>> GetLastScopeVariables() const {
     std::vector<std::shared_ptr<TIDVariable>> res;
     for (auto [name, var] : nodes_.back().variables_)
       res.push_back(var);
+    std::sort(res.begin(), res.end(), [](const auto & lhs, const auto & rhs) {
+      return lhs->GetAddress() < rhs->GetAddress();
+    });
     return res;
   }
 
   uint64_t GetNextAddress() const { return nodes_.back().next_address_; }
 
-  std::wstring GetScopeNameOfVariable(const std::wstring & name) const {
+  std::string GetScopeNameOfVariable(const std::string & name) const {
     for (size_t scope_index = nodes_.size() - 1; ~scope_index; --scope_index)
       if (nodes_[scope_index].variables_.count(name))
         return nodes_[scope_index].func_name;
@@ -282,31 +280,31 @@ class TID {
     return {};
   }
 
-  void LoadVariableAddress(const std::wstring & name, RPN & rpn) const;
+  void LoadVariableAddress(const std::string & name, RPN & rpn) const;
 
  public:
   void AddScope();
-  void AddFunctionScope(const std::wstring & name, const std::shared_ptr<TIDVariableType> & return_type);
+  void AddFunctionScope(const std::string & name, const std::shared_ptr<TIDVariableType> & return_type);
   void RemoveScope();
   void RemoveFunctionScope();
   void AddComplexStruct(const Lexeme & lexeme,
                         const std::shared_ptr<TIDVariableType> & complex_struct);
-  void AddVariable(const Lexeme & lexeme, const std::wstring & name,
+  void AddVariable(const Lexeme & lexeme, const std::string & name,
                    const std::shared_ptr<TIDVariableType> & type);
   uint64_t AddTemporaryInstance(const Lexeme & lexeme,
                                 const std::shared_ptr<TIDVariableType> & type);
 
  private:
-  std::wstring GetCurrentPrefix() const;
+  std::string GetCurrentPrefix() const;
 
  private:
   struct TIDNode {
     TIDNode() {}
-    std::map<std::wstring, std::shared_ptr<TIDVariableType>> complex_structs_;
-    std::map<std::wstring, std::shared_ptr<TIDVariable>> variables_;
+    std::map<std::string, std::shared_ptr<TIDVariableType>> complex_structs_;
+    std::map<std::string, std::shared_ptr<TIDVariable>> variables_;
     uint32_t child_node_cnt_ = 0;
     uint64_t next_address_ = 0;
-    std::wstring func_name;
+    std::string func_name;
   };
 
   uint32_t temp_structs = 0;
@@ -91,131 +91,6 @@ PrimitiveVariableType LeastCommonType(PrimitiveVariableType lhs, PrimitiveVariab
   else return lhs;
 }
 
-PrimitiveVariableType NumericTypeFromString(const std::wstring & val) {
-  bool is_decimal = false;
-  for (wchar_t ch : val)
-    if (ch == L'.')
-      is_decimal = true;
-  std::wstring suf;
-  for (size_t i = val.size() - 1; i > 0 && !std::isdigit(val[i]); --i) {
-    suf.push_back(val[i]);
-  }
-  if (is_decimal)
-    return suf.empty() ? PrimitiveVariableType::kF64 : PrimitiveVariableType::kF32;
-  else {
-    if (suf.empty()) return PrimitiveVariableType::kInt32;
-    bool us = false;
-    if (suf.back() == 'u' || suf.back() == 'U') {
-      us = true;
-      suf.pop_back();
-    }
-    if (suf.empty()) return PrimitiveVariableType::kUint32;
-    wchar_t ch = suf.back();
-    switch (ch) {
-      case 't':
-      case 'T':
-        return us ? PrimitiveVariableType::kUint8 : PrimitiveVariableType::kInt8;
-      case 's':
-      case 'S':
-        return us ? PrimitiveVariableType::kUint16 : PrimitiveVariableType::kInt16;
-      case 'i':
-      case 'I':
-        return us ? PrimitiveVariableType::kUint32 : PrimitiveVariableType::kInt32;
-      case 'l':
-      case 'L':
-        return us ? PrimitiveVariableType::kUint64 : PrimitiveVariableType::kInt64;
-    }
-  }
-  // should be unreachable
-  return PrimitiveVariableType::kInt32;
-}
-
-uint64_t value[1 << 16];
-void SetUpValue() {
-  static bool set_up = false;
-  if (!set_up) {
-    std::fill(value, value + (1 << 16), -1);
-    value[L'0'] = 0;
-    value[L'1'] = 1;
-    value[L'2'] = 2;
-    value[L'3'] = 3;
-    value[L'4'] = 4;
-    value[L'5'] = 5;
-    value[L'6'] = 6;
-    value[L'7'] = 7;
-    value[L'8'] = 8;
-    value[L'9'] = 9;
-    value[L'a'] = value[L'A'] = 10;
-    value[L'b'] = value[L'B'] = 11;
-    value[L'c'] = value[L'C'] = 12;
-    value[L'd'] = value[L'D'] = 13;
-    value[L'e'] = value[L'E'] = 14;
-    value[L'f'] = value[L'F'] = 15;
-    set_up = true;
-  }
-}
-
-uint64_t IntegerFromString(const std::wstring & val, PrimitiveVariableType type) {
-  SetUpValue();
-  uint64_t num = 0;
-  uint64_t base = 10;
-  size_t i = 0;
-  if (val.size() > 2 && val[0] == L'0' && val[1] == L'x') {
-    base = 16;
-    i = 2;
-  }
-  for (; i < val.size(); ++i) {
-    num *= base;
-    num += value[val[i]];
-  }
-
-  switch (type) {
-    case PrimitiveVariableType::kInt8:
-    case PrimitiveVariableType::kUint8:
-      num &= (1ll << 8) - 1;
-      break;
-    case PrimitiveVariableType::kInt16:
-    case PrimitiveVariableType::kUint16:
-      num &= (1ll << 16) - 1;
-      break;
-    case PrimitiveVariableType::kInt32:
-    case PrimitiveVariableType::kUint32:
-      num &= (1ll << 32) - 1;
-      break;
-    case PrimitiveVariableType::kInt64:
-    case PrimitiveVariableType::kUint64:
-      break;
-    default:
-      assert(false); // :)
-  }
-  return num;
-}
-
-uint64_t DecimalFromString(const std::wstring & val, PrimitiveVariableType type) {
-  SetUpValue();
-  uint64_t result;
-  std::string number;
-  number.resize(val.size());
-  for (size_t i = 0; i < val.size(); ++i)
-    number[i] = static_cast<char>(val[i]);
-  if (number.back() == 'f') number.pop_back();
-  double num = std::stod(number);
-  switch (type) {
-    case PrimitiveVariableType::kF32:
-      {
-        float num_fl = static_cast<float>(num);
-        result = *reinterpret_cast<uint32_t*>(&num_fl);
-      }
-      break;
-    case PrimitiveVariableType::kF64:
-      result = *reinterpret_cast<uint64_t*>(&num);
-      break;
-    default:
-      assert(false); // :)
-  }
-  return result;
-}
-
 void Cast(const std::shared_ptr<TIDValue> & from, const std::shared_ptr<TIDVariableType> & to, RPN & rpn) {
   assert(CanCast(from, to));
   auto from_type = from->GetType();
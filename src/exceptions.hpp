@@ -1,6 +1,7 @@
 #pragma once
 
 #include <exception>
+#include <map>
 #include <memory>
 #include <stdexcept>
 #include <string>
@@ -162,17 +163,35 @@ class NumberNotFinishedError : public LexicalAnalysisError {
   }
 };
 
+class NumberOverflowError : public LexicalAnalysisError {
+ public:
+  NumberOverflowError(size_t index) : LexicalAnalysisError(index) {}
+
+  const char* what() const noexcept override {
+    return "Number does not fit its type";
+  }
+};
+
+class InvalidUtf8Error : public LexicalAnalysisError {
+ public:
+  InvalidUtf8Error(size_t index) : LexicalAnalysisError(index) {}
+
+  const char* what() const noexcept override {
+    return "Invalid UTF-8 sequence";
+  }
+};
+
 class UnknownLexeme : public LexicalAnalysisError {
  public:
-  UnknownLexeme(size_t index, const std::wstring & value) : LexicalAnalysisError(index), value_(value) {}
+  UnknownLexeme(size_t index, const std::string & value) : LexicalAnalysisError(index), value_(value) {}
 
-  std::wstring GetValue() const { return value_; }
+  std::string GetValue() const { return value_; }
 
   const char* what() const noexcept override {
     return "Number started but not finished";
   }
  private:
-  std::wstring value_;
+  std::string value_;
 };
 
 // ==============================
@@ -376,107 +395,133 @@ class LoopInstructionsOutsideOfLoop : public SemanticsAnalysisError {
   }
 };
 
-class VoidNotExpected : public SemanticsAnalysisError {
+class CaseOutsideOfSwitch : public SemanticsAnalysisError {
  public:
-  VoidNotExpected(const Lexeme & lexeme) : SemanticsAnalysisError(lexeme) {}
+  CaseOutsideOfSwitch(const Lexeme & lexeme) : SemanticsAnalysisError(lexeme) {}
 
   const char* what() const noexcept override {
-    return "Void is not applicable here";
+    return "Case/default outside of switch";
   }
 };
 
-class FunctionParameterListDoesNotMatch : public SemanticsAnalysisError {
+class SwitchTypeNotIntegral : public SemanticsAnalysisError {
  public:
-  FunctionParameterListDoesNotMatch(const Lexeme & lexeme,
-      const std::shared_ptr<TIDFunctionVariableType> & function_type,
-      const std::vector<std::shared_ptr<TIDValue>> & provided)
-    : SemanticsAnalysisError(lexeme), function_type_(function_type), provided_(provided) {}
-
-  std::shared_ptr<TIDFunctionVariableType> GetFunctionType() const { return function_type_; }
-  std::vector<std::shared_ptr<TIDValue>> GetProvided() const { return provided_; }
+  SwitchTypeNotIntegral(const Lexeme & lexeme) : SemanticsAnalysisError(lexeme) {}
 
   const char* what() const noexcept override {
-    return "Calling a function with incorrect parameter list";
+    return "Switch value has to be of integer or char type";
   }
-
- private:
-  std::shared_ptr<TIDFunctionVariableType> function_type_;
-  std::vector<std::shared_ptr<TIDValue>> provided_;
 };
 
-class NewIncorrectUsage : public SemanticsAnalysisError {
+class CaseLabelNotLiteral : public SemanticsAnalysisError {
  public:
-  NewIncorrectUsage(const Lexeme & lexeme, const std::shared_ptr<TIDVariableType> & got)
-    : SemanticsAnalysisError(lexeme), got_(got) {}
-
-  std::shared_ptr<TIDVariableType> GetGotType() const { return got_; }
+  CaseLabelNotLiteral(const Lexeme & lexeme) : SemanticsAnalysisError(lexeme) {}
 
   const char* what() const noexcept override {
-    return "Usage: new(x) - returns x*, where x is a type; new(x, size) - returns x[], where x is an array type, size is an integer";
+    return "Case label has to be an integer or char literal";
   }
-
- private:
-  std::shared_ptr<TIDVariableType> got_;
 };
 
-class DeleteIncorrectUsage : public SemanticsAnalysisError {
+class DuplicateCaseLabel : public SemanticsAnalysisError {
  public:
-  DeleteIncorrectUsage(const Lexeme & lexeme, const std::shared_ptr<TIDVariableType> & got)
-    : SemanticsAnalysisError(lexeme), got_(got) {}
-
-  std::shared_ptr<TIDVariableType> GetGotType() const { return got_; }
+  DuplicateCaseLabel(const Lexeme & lexeme) : SemanticsAnalysisError(lexeme) {}
 
   const char* what() const noexcept override {
-    return "Usage: delete(x), where x is a pointer or an array";
+    return "Duplicate case label";
   }
-
- private:
-  std::shared_ptr<TIDVariableType> got_;
 };
 
-class SizeIncorrectUsage : public SemanticsAnalysisError {
+class VoidNotExpected : public SemanticsAnalysisError {
  public:
-  SizeIncorrectUsage(const Lexeme & lexeme, const std::shared_ptr<TIDVariableType> & got)
-    : SemanticsAnalysisError(lexeme), got_(got) {}
-
-  std::shared_ptr<TIDVariableType> GetGotType() const { return got_; }
+  VoidNotExpected(const Lexeme & lexeme) : SemanticsAnalysisError(lexeme) {}
 
   const char* what() const noexcept override {
-    return "Usage: size(x) - length of x where x is an array";
+    return "Void is not applicable here";
   }
-
- private:
-  std::shared_ptr<TIDVariableType> got_;
 };
 
-class ReadIncorrectUsage : public SemanticsAnalysisError {
+class FunctionParameterListDoesNotMatch : public SemanticsAnalysisError {
  public:
-  ReadIncorrectUsage(const Lexeme & lexeme, const std::shared_ptr<TIDVariableType> & got)
-      : SemanticsAnalysisError(lexeme), got_(got) {}
+  FunctionParameterListDoesNotMatch(const Lexeme & lexeme,
+      const std::shared_ptr<TIDFunctionVariableType> & function_type,
+      const std::vector<std::shared_ptr<TIDValue>> & provided)
+    : SemanticsAnalysisError(lexeme), function_type_(function_type), provided_(provided) {}
 
-  std::shared_ptr<TIDVariableType> GetGotType() const { return got_; }
+  std::shared_ptr<TIDFunctionVariableType> GetFunctionType() const { return function_type_; }
+  std::vector<std::shared_ptr<TIDValue>> GetProvided() const { return provided_; }
 
   const char* what() const noexcept override {
-    return "Usage: read(x), where x is non-const variable/temporary reference to char[]";
+    return "Calling a function with incorrect parameter list";
   }
 
  private:
-  std::shared_ptr<TIDVariableType> got_;
+  std::shared_ptr<TIDFunctionVariableType> function_type_;
+  std::vector<std::shared_ptr<TIDValue>> provided_;
 };
 
-class WriteIncorrectUsage : public SemanticsAnalysisError {
+// Builtin function got arguments it does not take; what() is usage of the builtin
+class BuiltinIncorrectUsage : public SemanticsAnalysisError {
  public:
-  WriteIncorrectUsage(const Lexeme & lexeme, const std::shared_ptr<TIDVariableType> & got)
-      : SemanticsAnalysisError(lexeme), got_(got) {}
+  BuiltinIncorrectUsage(const Lexeme & lexeme, std::string builtin)
+      : SemanticsAnalysisError(lexeme), builtin_(std::move(builtin)) {}
 
-  std::shared_ptr<TIDVariableType> GetGotType() const { return got_; }
+  const std::string & GetBuiltin() const { return builtin_; }
 
   const char* what() const noexcept override {
-    return "Usage: write(x), where x is char[]";
+    auto it = kUsages.find(builtin_);
+    return it != kUsages.end() ? it->second : "Incorrect usage of builtin function";
   }
 
  private:
-  std::shared_ptr<TIDVariableType> got_;
+  static constexpr const char * kFloatIntrinsicUsage =
+      "Usage: sqrt(x), exp(x), log(x), sin(x), cos(x) - f32 if x is f32, f64 otherwise, where x is a number";
+  static constexpr const char * kRoundingUsage =
+      "Usage: floor(x), ceil(x) - x rounded, of the same type as x, where x is a number";
+  static constexpr const char * kBitCountUsage =
+      "Usage: popcount(x), clz(x), ctz(x) - number of set, leading zero or trailing zero bits in x as int32, "
+      "where x is an integer";
+  static constexpr const char * kRotateUsage = "Usage: rotl(x, n), rotr(x, n) - x rotated by n bits, where x is an integer";
+  static constexpr const char * kParseUsage =
+      "Usage: parseint(s[, from[, to]]) / parsefloat(s[, from[, to]]) - number in [from; to) of s, where s is char[]";
+
+  inline static const std::map<std::string, const char *> kUsages = {
+    { "new", "Usage: new(x) - returns x*, where x is a type; new(x, size) - returns x[], where x is an array type, size is an integer" },
+    { "delete", "Usage: delete(x), where x is a pointer or an array" },
+    { "size", "Usage: size(x) - length of x where x is an array" },
+    { "read", "Usage: read(x), where x is non-const variable/temporary reference to char[]" },
+    { "write", "Usage: write(x), where x is char[] or value of primitive type" },
+    { "mmap", "Usage: mmap(path) - read-only char[] with contents of file, where path is char[]" },
+    { "readbin", "Usage: readbin(x[, path]), where x is non-const variable/temporary reference to array of primitive type "
+                 "and path is char[]" },
+    { "writebin", "Usage: writebin(x[, path]), where x is array of primitive type and path is char[]" },
+    { "tostr", "Usage: tostr(x) - x written into char[], where x is value of primitive type" },
+    { "parseint", kParseUsage }, { "parsefloat", kParseUsage },
+    { "strcmp", "Usage: strcmp(a, b) - -1, 0 or 1 if a is less, equal or greater than b, where a and b are char[]" },
+    { "concat", "Usage: concat(a, b) - new char[] with b appended to a, where a and b are char[]" },
+    { "find", "Usage: find(s, t[, from]) - index of first t in s starting from from, or -1, where s and t are char[]" },
+    { "substr", "Usage: substr(s, from[, to]) - new char[] with [from; to) of s, where s is char[]" },
+    { "strhash", "Usage: strhash(s) - uint64 hash of contents of s, where s is char[]" },
+    { "arrsort", "Usage: arrsort(a[, from[, to]]) - sorts [from; to) of a, where a is array of non-const primitive type" },
+    { "arrfill", "Usage: arrfill(a, v[, from[, to]]) - sets [from; to) of a to v, "
+                 "where a is array of non-const primitive type" },
+    { "arrcopy", "Usage: arrcopy(a, at, b[, from[, to]]) - copies [from; to) of b to a starting at at, "
+                 "where a and b are arrays of the same type and elements of a are not const" },
+    { "arrsum", "Usage: arrsum(a) - sum of elements of a as int64, uint64 or f64, where a is array of primitive type" },
+    { "arrmin", "Usage: arrmin(a) - minimal element of non-empty a, where a is array of primitive type" },
+    { "arrmax", "Usage: arrmax(a) - maximal element of non-empty a, where a is array of primitive type" },
+    { "lowerbound", "Usage: lowerbound(a, v[, from[, to]]) - index of first element not less than v "
+                    "in sorted [from; to) of a, where a is array of primitive type" },
+    { "sqrt", kFloatIntrinsicUsage }, { "exp", kFloatIntrinsicUsage }, { "log", kFloatIntrinsicUsage },
+    { "sin", kFloatIntrinsicUsage }, { "cos", kFloatIntrinsicUsage },
+    { "floor", kRoundingUsage }, { "ceil", kRoundingUsage },
+    { "abs", "Usage: abs(x) - absolute value of x, of the same type as x, where x is a number" },
+    { "fma", "Usage: fma(a, b, c) - a * b + c rounded once, f32 if a is f32, f64 otherwise, where a, b and c are numbers" },
+    { "popcount", kBitCountUsage }, { "clz", kBitCountUsage }, { "ctz", kBitCountUsage },
+    { "rotl", kRotateUsage }, { "rotr", kRotateUsage },
+    { "bswap", "Usage: bswap(x) - x with bytes in reverse order, where x is an integer" }
+  };
+
+  std::string builtin_;
 };
 
 // ======================
@@ -564,6 +609,51 @@ class DivisionByZero : public RuntimeError {
   }
 };
 
+class OutputError : public RuntimeError {
+ public:
+  OutputError() : RuntimeError() {}
+
+  const char* what() const noexcept override {
+    return "Failed to write program output";
+  }
+};
+
+class FileMappingError : public RuntimeError {
+ public:
+  FileMappingError() : RuntimeError() {}
+
+  const char* what() const noexcept override {
+    return "Cannot map file into memory";
+  }
+};
+
+class FileAccessError : public RuntimeError {
+ public:
+  FileAccessError() : RuntimeError() {}
+
+  const char* what() const noexcept override {
+    return "Cannot read or write file";
+  }
+};
+
+class NumberParseError : public RuntimeError {
+ public:
+  NumberParseError() : RuntimeError() {}
+
+  const char* what() const noexcept override {
+    return "No number to parse or it is out of range";
+  }
+};
+
+class EmptyArrayError : public RuntimeError {
+ public:
+  EmptyArrayError() : RuntimeError() {}
+
+  const char* what() const noexcept override {
+    return "Minimum or maximum of empty array";
+  }
+};
+
 class NullptrAccessedException : public RuntimeError {
  public:
   NullptrAccessedException() : RuntimeError() {}
@@ -2,9 +2,9 @@
 #include "TID.hpp"
 #include <memory>
 
-std::wstring ToString(RPNOperatorType type) {
+std::string ToString(RPNOperatorType type) {
 #define OperatorCase(x) case RPNOperatorType::x:\
-  return L"" #x
+  return "" #x
   switch (type) {
     OperatorCase(kLoad);
     OperatorCase(kStoreDA);
@@ -12,6 +12,8 @@ std::wstring ToString(RPNOperatorType type) {
     OperatorCase(kJmp);
     OperatorCase(kCall);
     OperatorCase(kJz);
+    OperatorCase(kJnz);
+    OperatorCase(kJumpTable);
     OperatorCase(kPush);
     OperatorCase(kPop);
     OperatorCase(kSP);
@@ -20,6 +22,23 @@ std::wstring ToString(RPNOperatorType type) {
     OperatorCase(kDelete);
     OperatorCase(kRead);
     OperatorCase(kWrite);
+    OperatorCase(kMap);
+    OperatorCase(kReadBinary);
+    OperatorCase(kWriteBinary);
+    OperatorCase(kFormat);
+    OperatorCase(kParse);
+    OperatorCase(kCompare);
+    OperatorCase(kConcat);
+    OperatorCase(kFind);
+    OperatorCase(kSubstring);
+    OperatorCase(kHash);
+    OperatorCase(kSort);
+    OperatorCase(kArrayFill);
+    OperatorCase(kArrayCopy);
+    OperatorCase(kSum);
+    OperatorCase(kMin);
+    OperatorCase(kMax);
+    OperatorCase(kLowerBound);
     OperatorCase(kReturn);
     OperatorCase(kFuncSP);
     OperatorCase(kDump);
@@ -46,6 +65,22 @@ std::wstring ToString(RPNOperatorType type) {
     OperatorCase(kBitwiseAnd);
     OperatorCase(kBitwiseOr);
     OperatorCase(kBitwiseXor);
+    OperatorCase(kPower);
+    OperatorCase(kSqrt);
+    OperatorCase(kAbs);
+    OperatorCase(kFloor);
+    OperatorCase(kCeil);
+    OperatorCase(kExp);
+    OperatorCase(kLog);
+    OperatorCase(kSin);
+    OperatorCase(kCos);
+    OperatorCase(kFma);
+    OperatorCase(kPopcount);
+    OperatorCase(kClz);
+    OperatorCase(kCtz);
+    OperatorCase(kRotateLeft);
+    OperatorCase(kRotateRight);
+    OperatorCase(kByteSwap);
     OperatorCase(kLess);
     OperatorCase(kMore);
     OperatorCase(kLessOrEqual);
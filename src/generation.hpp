@@ -12,7 +12,7 @@ class RPNNode {
  public:
   virtual ~RPNNode() = default;
   NodeType GetNodeType() const { return type_; }
-  virtual std::wstring ToString() const = 0;
+  virtual std::string ToString() const = 0;
 
  protected:
   RPNNode(NodeType type) : type_(type) {}
@@ -26,7 +26,7 @@ class RPNOperand : public RPNNode {
   RPNOperand(uint64_t value) : RPNNode(NodeType::kOperand), value_(value) {}
 
   uint64_t GetValue() const { return value_; }
-  std::wstring ToString() const override { return std::to_wstring(value_); }
+  std::string ToString() const override { return std::to_string(value_); }
 
  private:
   uint64_t value_;
@@ -36,13 +36,13 @@ class RPNOperand : public RPNNode {
 //  and it is replaced with RPNOperandNode as they are being merged
 class RPNReferenceOperand : public RPNNode {
  public:
-  RPNReferenceOperand(const std::wstring & name) : RPNNode(NodeType::kReferenceOperand), name_(name) {}
+  RPNReferenceOperand(const std::string & name) : RPNNode(NodeType::kReferenceOperand), name_(name) {}
 
-  std::wstring GetName() const { return name_; }
-  std::wstring ToString() const override { return name_; }
+  std::string GetName() const { return name_; }
+  std::string ToString() const override { return name_; }
 
  private:
-  std::wstring name_;
+  std::string name_;
 };
 
 class RPNRelativeOperand : public RPNNode {
@@ -50,7 +50,7 @@ class RPNRelativeOperand : public RPNNode {
   RPNRelativeOperand(uint64_t value) : RPNNode(NodeType::kRelativeOperand), value_(value) {}
 
   uint64_t GetValue() const { return value_; }
-  std::wstring ToString() const override { return std::to_wstring(value_); }
+  std::string ToString() const override { return std::to_string(value_); }
 
  private:
   uint64_t value_;
@@ -72,6 +72,9 @@ enum class RPNOperatorType : uint8_t {
   kCall,      // Unary: Same as jmp, but used to call function. Difference is that when run, $arg will be
               //        recorded as a function address to be used with kFuncSP
   kJz,        // Binary: Jumps to $arg2 if $arg1 is false
+  kJnz,       // Binary: Jumps to $arg2 if $arg1 is true
+  kJumpTable, // Ternary: Jumps to $arg3 + 2 * min($arg1, $arg2); $arg3 is table of $arg2 + 1 entries
+              //          "[target] kJmp", last one is for index out of range
   kPush,      // Binary; Pushes to stack; $arg1 is size of memory to be reserved;
               //         $arg2 is address of function called; pushes new SP to RPN
   kPop,       // No args; Removes from stack
@@ -80,7 +83,29 @@ enum class RPNOperatorType : uint8_t {
   kNew,       // Unary; allocates new memory of size ($arg as uint32) bytes on heap; pushes address to RPN
   kDelete,    // Binary; deletes memory at $arg1 of size ($arg2 as uint32)
   kRead,      // Unary; reads string to char[] at $arg ($arg is address of variable)
-  kWrite,     // Unary; writes char[] that is at $arg ($arg is address of an array)
+  kWrite,     // Unary; writes char[] that is at $arg ($arg is address of an array);
+              //        if type_ is set, writes $arg of {type_} formatted as text
+  kMap,       // Unary; maps file named by char[] at $arg read-only into memory; pushes address of char[]
+  kReadBinary,  // 3 args; reads raw elements of size $arg2 from file named by char[] at $arg3 (stdin if 0)
+                //         into new array, stores its address to variable at $arg1
+  kWriteBinary, // 3 args; writes raw elements (of size $arg2) of array at $arg1 to file named by char[]
+                //         at $arg3 (stdout if 0)
+  kFormat,    // Unary; pushes address of new char[] with $arg of {type_} formatted as text
+  kParse,     // 3 args; pushes number of {type_} (int64 or f64) parsed from [$arg2; $arg3) of char[] at $arg1
+  kCompare,   // Binary; pushes -1, 0 or 1 (int32) if char[] at $arg1 is less, equal or greater than one at $arg2
+  kConcat,    // Binary; pushes address of new char[] with char[] at $arg2 appended to one at $arg1
+  kFind,      // 3 args; pushes index (int64) of first char[] at $arg2 in char[] at $arg1 from $arg3, or -1
+  kSubstring, // 3 args; pushes address of new char[] with [$arg2; $arg3) of char[] at $arg1
+  kHash,      // Unary; pushes hash (uint64) of contents of char[] at $arg
+  kSort,      // 3 args; sorts elements [$arg2; $arg3) of array of {type_} at $arg1
+  kArrayFill, // 4 args; sets elements [$arg3; $arg4) of array of {type_} at $arg1 to $arg2
+  kArrayCopy, // 6 args; copies elements (of size $arg6) [$arg4; $arg5) of array at $arg3
+              //         to array at $arg1 starting from $arg2
+  kSum,       // Unary; pushes sum (int64, uint64 or f64) of array of {type_} at $arg
+  kMin,       // Unary; pushes minimal element of array of {type_} at $arg
+  kMax,       // Unary; pushes maximal element of array of {type_} at $arg
+  kLowerBound,  // 4 args; pushes index (int64) of first element not less than $arg2
+                //         in sorted [$arg3; $arg4) of array of {type_} at $arg1
   kReturn,    // No args; Jumps back to return pointer (halts if return pointer is -1)
   kFuncSP,    // Unary; pushes (function that was called by jmp $arg)'s latest SP to RPN
   kDump,      // Unary; does nothing (takes $arg and disappears)
@@ -111,6 +136,26 @@ enum class RPNOperatorType : uint8_t {
   kBitwiseAnd, // Binary; $arg1 & $arg2
   kBitwiseOr, // Binary; $arg1 | $arg2
   kBitwiseXor, // Binary; $arg1 ^ $arg2
+  kPower, // Binary; $arg1 ** $arg2 (by squaring for integers)
+
+  // Math intrinsics ({operator} on {type} returns {type})
+  kSqrt,  // Unary; sqrt($arg)
+  kAbs,   // Unary; |$arg|
+  kFloor, // Unary; floor($arg)
+  kCeil,  // Unary; ceil($arg)
+  kExp,   // Unary; e ** $arg
+  kLog,   // Unary; natural logarithm of $arg
+  kSin,   // Unary; sin($arg)
+  kCos,   // Unary; cos($arg)
+  kFma,   // 3 args; $arg1 * $arg2 + $arg3 rounded once
+
+  // Bit intrinsics on integer {type}
+  kPopcount,    // Unary; pushes number of set bits in $arg (int32)
+  kClz,         // Unary; pushes number of leading zero bits in $arg (int32), width of {type} if $arg is 0
+  kCtz,         // Unary; pushes number of trailing zero bits in $arg (int32), width of {type} if $arg is 0
+  kRotateLeft,  // Binary; pushes $arg1 rotated left by $arg2 bits
+  kRotateRight, // Binary; pushes $arg1 rotated right by $arg2 bits
+  kByteSwap,    // Unary; pushes $arg with bytes in reverse order
 
   // Logical operators ({operator} on {type} returns bool)
   kInvert,  // Unary; !$arg
@@ -122,7 +167,7 @@ enum class RPNOperatorType : uint8_t {
   kNotEqual // Binary; $arg1 != $arg2
 };
 
-std::wstring ToString(RPNOperatorType);
+std::string ToString(RPNOperatorType);
 
 class RPNOperator : public RPNNode {
  public:
@@ -133,7 +178,7 @@ class RPNOperator : public RPNNode {
 
   RPNOperatorType GetOperatorType() const { return op_; }
   PrimitiveVariableType GetVariableType() const { return type_; }
-  std::wstring ToString() const override { return ::ToString(op_); }
+  std::string ToString() const override { return ::ToString(op_); }
 
  private:
   RPNOperatorType op_;
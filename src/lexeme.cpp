@@ -1,38 +1,53 @@
 #include "lexeme.hpp"
+#include "terminal_formatting.hpp"
 
-std::map<LexemeType, std::vector<std::wstring>> GetLexemeStrings() {
-  std::map<LexemeType, std::vector<std::wstring>> ans;
-  ans[LexemeType::kReserved] = {
-    L"for", L"while", L"do", L"foreach", L"of", L"if", L"elif", L"else", L"return", L"break",
-    L"continue", L"struct", L"const", L"true", L"false", L"as", L"new", L"delete",
-    L"size", L"sizeof", L"read", L"write"
-  };
-  ans[LexemeType::kOperator] = {
-    L"+", L"-", L"*", L"/", L"%", L"++", L"--", L"&", L"|", L"^", L"&&", L"||", L"==", L"!=",
-    L"<", L">", L"<=", L">=", L"<<", L">>", L"=", L"+=", L"-=", L"*=", L"/=", L"%=",
-    L"<<=", L">>=", L"&=", L"^=", L"|=", L".", L"**", L"**=", L"~"
-  };
-  ans[LexemeType::kPunctuation] = {
-    L",", L";", L"{", L"}", L"=>"
-  };
-  ans[LexemeType::kParenthesis] = {
-    L"(", L")"
-  };
-  ans[LexemeType::kBracket] = {
-    L"[", L"]"
-  };
-  ans[LexemeType::kVariableType] = {
-    L"int8", L"int16", L"int32", L"int64", L"uint8", L"uint16", L"uint32", L"uint64", L"f32", L"f64", /*L"string",*/
-    /*L"var", */L"void", L"bool", /*L"func", L"auto",*/ L"char"
-  };
-  return ans;
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+// Deques never move stored strings, so keys of symbol_ids stay valid
+std::deque<std::string> symbol_texts = { "" };
+std::unordered_map<std::string_view, SymbolId> symbol_ids = { { symbol_texts.front(), kEmptySymbol } };
+
+bool symbols_shared = false;
+std::mutex symbols_mutex;
+// Ids never change, so a thread keeps ones it has seen and locks only for new texts
+thread_local std::unordered_map<std::string_view, SymbolId> seen_symbol_ids;
+
+SymbolId InternSymbolUnlocked(std::string_view text) {
+  auto it = symbol_ids.find(text);
+  if (it != symbol_ids.end())
+    return it->second;
+  SymbolId id = static_cast<SymbolId>(symbol_texts.size());
+  const std::string & stored = symbol_texts.emplace_back(text);
+  symbol_ids.emplace(stored, id);
+  return id;
+}
+
+SymbolId InternSymbol(std::string_view text) {
+  if (!symbols_shared)
+    return InternSymbolUnlocked(text);
+  auto it = seen_symbol_ids.find(text);
+  if (it != seen_symbol_ids.end())
+    return it->second;
+  std::lock_guard<std::mutex> lock(symbols_mutex);
+  SymbolId id = InternSymbolUnlocked(text);
+  seen_symbol_ids.emplace(symbol_texts[id], id);
+  return id;
+}
+
+void SetSymbolsShared(bool shared) {
+  symbols_shared = shared;
 }
 
+const std::string & GetSymbol(SymbolId id) {
+  return symbol_texts[id];
+}
 
-std::wstring ToString(LexemeType type) {
+std::string ToString(LexemeType type) {
   switch (type) {
 #define LexemeTypeCase(name) case LexemeType::name:\
-    return L""#name
+    return ""#name
     LexemeTypeCase(kReserved);
     LexemeTypeCase(kIdentifier);
     LexemeTypeCase(kNumericLiteral);
@@ -50,6 +65,6 @@ std::wstring ToString(LexemeType type) {
 }
 
 std::wostream& operator << (std::wostream & out, const Lexeme & lexeme) {
-  out << ToString(lexeme.type_) << ": " << lexeme.val_;
+  out << ToString(lexeme.type_) << ": " << lexeme.GetValue();
   return out;
 }
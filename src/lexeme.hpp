@@ -5,6 +5,8 @@
 #include <vector>
 #include <map>
 #include <sstream>
+#include <string_view>
+#include "primitive_type.hpp"
 
 enum class LexemeType : uint8_t {
   kReserved       = 0,
@@ -21,23 +23,93 @@ enum class LexemeType : uint8_t {
   kNull           = 255
 };
 
-std::wstring ToString(LexemeType type);
+std::string ToString(LexemeType type);
+
+// Id of interned text of a lexeme; equal texts have equal ids
+using SymbolId = uint32_t;
+constexpr SymbolId kEmptySymbol = 0;
+
+// Text is UTF-8 and is stored once
+SymbolId InternSymbol(std::string_view text);
+const std::string & GetSymbol(SymbolId id);
+// While symbols are shared, several threads may intern at once (GetSymbol is not allowed meanwhile)
+void SetSymbolsShared(bool shared);
 
 class Lexeme {
  public:
-  Lexeme() : type_(LexemeType::kUnknown), val_() {}
-  Lexeme(const LexemeType & type, const std::wstring & value, size_t index) : type_(type), val_(value), index_(index) {}
+  Lexeme() : type_(LexemeType::kUnknown), symbol_(kEmptySymbol), index_(0) {}
+  Lexeme(const LexemeType & type, SymbolId symbol, size_t index) : type_(type), symbol_(symbol), index_(index) {}
+  Lexeme(const LexemeType & type, std::string_view value, size_t index)
+    : type_(type), symbol_(InternSymbol(value)), index_(index) {}
+  Lexeme(const LexemeType & type, std::string_view value, size_t index,
+         PrimitiveVariableType literal_type, uint64_t literal)
+    : type_(type), literal_type_(literal_type), symbol_(InternSymbol(value)), index_(index), literal_(literal) {}
 
   LexemeType GetType() const { return type_; }
-  std::wstring GetValue() const { return val_; }
+  SymbolId GetSymbol() const { return symbol_; }
+  const std::string & GetValue() const { return ::GetSymbol(symbol_); }
   size_t GetIndex() const { return index_; }
+  Lexeme WithIndex(size_t index) const {
+    Lexeme result = *this;
+    result.index_ = index;
+    return result;
+  }
+
+  // Numeric and char literals are decoded by lexer: bits of value and its type
+  PrimitiveVariableType GetLiteralType() const { return literal_type_; }
+  uint64_t GetLiteral() const { return literal_; }
 
   friend std::wostream& operator << (std::wostream & out, const Lexeme & lexeme);
 
  private:
   LexemeType type_;
-  std::wstring val_;
+  PrimitiveVariableType literal_type_ = PrimitiveVariableType::kUnknown;
+  SymbolId symbol_;
   size_t index_;
+  uint64_t literal_ = 0;
+};
+
+struct LexemeString {
+  std::string_view text;
+  LexemeType type;
+};
+
+// Reserved words and variable types; they are lexed as identifiers and then recognized
+constexpr LexemeString kWords[] = {
+  { "for", LexemeType::kReserved }, { "while", LexemeType::kReserved }, { "do", LexemeType::kReserved },
+  { "foreach", LexemeType::kReserved }, { "of", LexemeType::kReserved }, { "if", LexemeType::kReserved },
+  { "elif", LexemeType::kReserved }, { "else", LexemeType::kReserved }, { "switch", LexemeType::kReserved },
+  { "case", LexemeType::kReserved }, { "default", LexemeType::kReserved }, { "return", LexemeType::kReserved },
+  { "break", LexemeType::kReserved }, { "continue", LexemeType::kReserved }, { "struct", LexemeType::kReserved },
+  { "const", LexemeType::kReserved }, { "true", LexemeType::kReserved }, { "false", LexemeType::kReserved },
+  { "as", LexemeType::kReserved }, { "new", LexemeType::kReserved }, { "delete", LexemeType::kReserved },
+  { "size", LexemeType::kReserved }, { "sizeof", LexemeType::kReserved }, { "read", LexemeType::kReserved },
+  { "write", LexemeType::kReserved },
+  { "int8", LexemeType::kVariableType }, { "int16", LexemeType::kVariableType },
+  { "int32", LexemeType::kVariableType }, { "int64", LexemeType::kVariableType },
+  { "uint8", LexemeType::kVariableType }, { "uint16", LexemeType::kVariableType },
+  { "uint32", LexemeType::kVariableType }, { "uint64", LexemeType::kVariableType },
+  { "f32", LexemeType::kVariableType }, { "f64", LexemeType::kVariableType }, /*"string",*/
+  /*"var", */{ "void", LexemeType::kVariableType }, { "bool", LexemeType::kVariableType },
+  /*"func", "auto",*/ { "char", LexemeType::kVariableType }
 };
 
-std::map<LexemeType, std::vector<std::wstring>> GetLexemeStrings();
+// Operators, punctuation, parentheses and brackets; the longest one matching is taken
+constexpr LexemeString kSymbols[] = {
+  { "+", LexemeType::kOperator }, { "-", LexemeType::kOperator }, { "*", LexemeType::kOperator },
+  { "/", LexemeType::kOperator }, { "%", LexemeType::kOperator }, { "++", LexemeType::kOperator },
+  { "--", LexemeType::kOperator }, { "&", LexemeType::kOperator }, { "|", LexemeType::kOperator },
+  { "^", LexemeType::kOperator }, { "&&", LexemeType::kOperator }, { "||", LexemeType::kOperator },
+  { "==", LexemeType::kOperator }, { "!=", LexemeType::kOperator }, { "<", LexemeType::kOperator },
+  { ">", LexemeType::kOperator }, { "<=", LexemeType::kOperator }, { ">=", LexemeType::kOperator },
+  { "<<", LexemeType::kOperator }, { ">>", LexemeType::kOperator }, { "=", LexemeType::kOperator },
+  { "+=", LexemeType::kOperator }, { "-=", LexemeType::kOperator }, { "*=", LexemeType::kOperator },
+  { "/=", LexemeType::kOperator }, { "%=", LexemeType::kOperator }, { "<<=", LexemeType::kOperator },
+  { ">>=", LexemeType::kOperator }, { "&=", LexemeType::kOperator }, { "^=", LexemeType::kOperator },
+  { "|=", LexemeType::kOperator }, { ".", LexemeType::kOperator }, { "**", LexemeType::kOperator },
+  { "**=", LexemeType::kOperator }, { "~", LexemeType::kOperator },
+  { ",", LexemeType::kPunctuation }, { ";", LexemeType::kPunctuation }, { "{", LexemeType::kPunctuation },
+  { "}", LexemeType::kPunctuation }, { "=>", LexemeType::kPunctuation }, { ":", LexemeType::kPunctuation },
+  { "(", LexemeType::kParenthesis }, { ")", LexemeType::kParenthesis },
+  { "[", LexemeType::kBracket }, { "]", LexemeType::kBracket }
+};
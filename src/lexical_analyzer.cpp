@@ -1,170 +1,605 @@
 #include "lexical_analyzer.hpp"
 #include "exceptions.hpp"
 #include "lexeme.hpp"
+#include "scan.hpp"
+#include "source.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <exception>
 #include <iostream>
+#include <thread>
 
-bool Fits(const std::wstring & code, size_t index, const std::wstring & token) {
-  if (index + token.size() > code.size())
-    return false;
-  for (size_t i = 0; i < token.size(); ++i)
-    if (code[index + i] != token[i])
-      return false;
-  return true;
+bool Fits(std::string_view code, size_t index, std::string_view token) {
+  return code.compare(index, token.size(), token) == 0;
 }
 
-bool IsDigit(wchar_t ch, bool is_hex) {
-  if (std::isdigit(ch))
+bool IsDigit(char ch, bool is_hex) {
+  if (IsDigitChar(ch))
     return true;
   if (!is_hex)
     return false;
-  return (L'a' <= ch && ch <= L'f') || (L'A' <= ch && ch <= L'F');
+  return ('a' <= ch && ch <= 'f') || ('A' <= ch && ch <= 'F');
 }
 
-std::vector<Lexeme> PerformLexicalAnalysis(const std::wstring & code) {
+// Non-ASCII characters (as whole UTF-8 sequences) are allowed in identifiers
+size_t IdentifierCharLength(std::string_view code, size_t index, bool first) {
+  unsigned char ch = static_cast<unsigned char>(code[index]);
+  if (ch < 0x80)
+    return IsLetterChar(code[index]) || ch == '_' || (!first && IsDigitChar(code[index])) ? 1 : 0;
+  size_t length = Utf8SequenceLength(code, index);
+  if (length == 0)
+    throw InvalidUtf8Error(index);
+  return length;
+}
 
-  static std::vector<std::pair<std::wstring, LexemeType>> identifier_overrides;
-  static std::vector<std::vector<std::pair<std::wstring, LexemeType>>> by_length;
+// Integer suffix at code[index]: 'u' for unsigned, then 't', 's', 'i' or 'l' for 8, 16, 32 or 64 bits
+size_t IntegerSuffix(std::string_view code, size_t index, PrimitiveVariableType & type) {
+  bool is_unsigned = false;
+  if (code[index] == 'u' || code[index] == 'U') {
+    is_unsigned = true;
+    type = PrimitiveVariableType::kUint32;
+    ++index;
+  }
+  if (index == code.size()) return index;
+  switch (code[index] | 0x20) {
+    case 't':
+      type = is_unsigned ? PrimitiveVariableType::kUint8 : PrimitiveVariableType::kInt8;
+      break;
+    case 's':
+      type = is_unsigned ? PrimitiveVariableType::kUint16 : PrimitiveVariableType::kInt16;
+      break;
+    case 'i':
+      type = is_unsigned ? PrimitiveVariableType::kUint32 : PrimitiveVariableType::kInt32;
+      break;
+    case 'l':
+      type = is_unsigned ? PrimitiveVariableType::kUint64 : PrimitiveVariableType::kInt64;
+      break;
+    default:
+      return index;
+  }
+  return index + 1;
+}
 
-  if (by_length.empty()) {
+// Hex literal of signed type may take all bits of it, so that 0xFFFFFFFF can be written; decimal one has to fit
+// in range of its type. Literal without suffix which does not fit int32 (or 32 bits, if it is hex) becomes int64,
+// then uint64
+uint64_t DecodeInteger(std::string_view digits, uint64_t base, bool has_suffix, PrimitiveVariableType & type,
+                       size_t index) {
+  uint64_t value = 0;
+  for (char ch : digits) {
+    uint64_t digit = IsDigitChar(ch) ? static_cast<uint64_t>(ch - '0') : static_cast<uint64_t>((ch | 0x20) - 'a' + 10);
+    if (__builtin_mul_overflow(value, base, &value) || __builtin_add_overflow(value, digit, &value))
+      throw NumberOverflowError(index);
+  }
+  if (!has_suffix && (base == 10 ? value > INT32_MAX : value >> 32))
+    type = value >> 63 ? PrimitiveVariableType::kUint64 : PrimitiveVariableType::kInt64;
+  uint32_t bits = 64;
+  bool is_signed = false;
+  switch (type) {
+    case PrimitiveVariableType::kInt8:
+      is_signed = true;
+      [[fallthrough]];
+    case PrimitiveVariableType::kUint8:
+      bits = 8;
+      break;
+    case PrimitiveVariableType::kInt16:
+      is_signed = true;
+      [[fallthrough]];
+    case PrimitiveVariableType::kUint16:
+      bits = 16;
+      break;
+    case PrimitiveVariableType::kInt32:
+      is_signed = true;
+      [[fallthrough]];
+    case PrimitiveVariableType::kUint32:
+      bits = 32;
+      break;
+    case PrimitiveVariableType::kInt64:
+      is_signed = true;
+      break;
+    default:
+      break;
+  }
+  // sign bit is not available to decimal literal
+  if (is_signed && base == 10) --bits;
+  if (bits < 64 && value >> bits)
+    throw NumberOverflowError(index);
+  return value;
+}
 
-    std::map<LexemeType, std::vector<std::wstring>> lexeme_strings = GetLexemeStrings();
-    for (const auto & [type, vec] : lexeme_strings) {
-      if (type == LexemeType::kReserved || type == LexemeType::kVariableType) {
-        for (const std::wstring & str : vec)
-          identifier_overrides.emplace_back(str, type);
-        continue;
-      }
-      for (const std::wstring & str : vec) {
-        while (by_length.size() <= str.size())
-          by_length.emplace_back();
-        by_length[str.size()].emplace_back(str, type);
-      }
+// Bits of f32 or f64 value of digits with '.'; it is rounded to double first, as std::stod did
+uint64_t DecodeDecimal(std::string_view digits, PrimitiveVariableType type, size_t index) {
+  // Exact powers of ten of double
+  static constexpr double kPowersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+  uint64_t mantissa = 0;
+  size_t significant = 0, fraction = 0;
+  bool in_fraction = false;
+  for (char ch : digits) {
+    if (ch == '.') {
+      in_fraction = true;
+      continue;
     }
+    if (significant || ch != '0')
+      ++significant;
+    if (significant <= 19)
+      mantissa = mantissa * 10 + static_cast<uint64_t>(ch - '0');
+    fraction += in_fraction;
+  }
+  double value;
+  // Clinger's fast path: both mantissa and power of ten are exact, so division is correctly rounded
+  if (significant <= 19 && mantissa <= (1ull << 53) && fraction <= 22) {
+    value = static_cast<double>(mantissa) / kPowersOfTen[fraction];
+  } else {
+    std::string copy(digits);
+    value = std::strtod(copy.c_str(), nullptr);
+  }
+  if (type == PrimitiveVariableType::kF32) {
+    float narrow = static_cast<float>(value);
+    if (std::isinf(narrow))
+      throw NumberOverflowError(index);
+    uint32_t bits;
+    std::memcpy(&bits, &narrow, sizeof(bits));
+    return bits;
+  }
+  if (std::isinf(value))
+    throw NumberOverflowError(index);
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+// Perfect hash of kWords, seed is searched at compile time
+constexpr uint32_t kWordHashBits = 10;
+constexpr uint32_t kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+static_assert(kWordCount < 255, "Word table keeps index + 1 in uint8_t");
+
+constexpr uint32_t WordHash(std::string_view word, uint32_t seed) {
+  uint32_t hash = seed ^ static_cast<uint32_t>(word.size());
+  for (size_t i = 0; i < word.size(); ++i)
+    hash = (hash ^ static_cast<unsigned char>(word[i])) * 16777619u;
+  return hash >> (32 - kWordHashBits);
+}
 
+constexpr uint32_t FindWordSeed() {
+  for (uint32_t seed = 1; seed < 1000; ++seed) {
+    std::array<bool, 1 << kWordHashBits> used{};
+    bool ok = true;
+    for (uint32_t i = 0; i < kWordCount && ok; ++i) {
+      uint32_t slot = WordHash(kWords[i].text, seed);
+      ok = !used[slot];
+      used[slot] = true;
+    }
+    if (ok) return seed;
   }
+  return 0;
+}
 
-  std::map<wchar_t, std::wstring> backslash_chars;
-  backslash_chars[L'n'] = L"\n";
-  backslash_chars[L'r'] = L"\r";
-  backslash_chars[L't'] = L"\t";
-  backslash_chars[L'\\'] = L"\\";
-  backslash_chars[L'\n'] = L"";
-  backslash_chars[L'"'] = L"\"";
-  backslash_chars[L'\''] = L"'";
+constexpr uint32_t kWordSeed = FindWordSeed();
+static_assert(kWordSeed != 0, "No perfect hash seed for kWords");
 
-  std::vector<Lexeme> result;
+// Index of word in kWords + 1 by its hash, 0 for empty slots
+constexpr std::array<uint8_t, 1 << kWordHashBits> BuildWordTable() {
+  std::array<uint8_t, 1 << kWordHashBits> table{};
+  for (uint32_t i = 0; i < kWordCount; ++i)
+    table[WordHash(kWords[i].text, kWordSeed)] = static_cast<uint8_t>(i + 1);
+  return table;
+}
 
-  for (size_t i = 0, j = 1; i < code.size(); i = j++) {
-    if (code[i] == L' ' || code[i] == L'\n' || code[i] == L'\t')
-      continue;
+constexpr std::array<uint8_t, 1 << kWordHashBits> kWordTable = BuildWordTable();
 
-    if (Fits(code, i, L"/*")) {                                   // multi-line comment
-      while (j + 1 < code.size() && !Fits(code, j, L"*/"))
-        ++j;
-      if (!Fits(code, j, L"*/"))
-        throw CommentNotEndedError(j);
-      j += 2;
+// Index in kWords, -1 if word is an identifier
+int FindWord(std::string_view word) {
+  uint8_t entry = kWordTable[WordHash(word, kWordSeed)];
+  if (entry == 0 || kWords[entry - 1].text != word) return -1;
+  return entry - 1;
+}
+
+// Trie of kSymbols over ASCII; node 0 is root, child 0 means there is no child
+constexpr size_t kSymbolCount = sizeof(kSymbols) / sizeof(kSymbols[0]);
+
+constexpr size_t CountSymbolPrefixes() {
+  size_t count = 1;
+  for (size_t i = 0; i < kSymbolCount; ++i)
+    for (size_t length = 1; length <= kSymbols[i].text.size(); ++length) {
+      bool seen = false;
+      for (size_t j = 0; j < i && !seen; ++j)
+        seen = kSymbols[j].text.size() >= length &&
+          kSymbols[j].text.substr(0, length) == kSymbols[i].text.substr(0, length);
+      count += !seen;
+    }
+  return count;
+}
+
+constexpr size_t kSymbolTrieSize = CountSymbolPrefixes();
+static_assert(kSymbolTrieSize < 256, "Symbol trie keeps nodes in uint8_t");
+
+struct SymbolTrie {
+  std::array<std::array<uint8_t, 128>, kSymbolTrieSize> next{};
+  std::array<int8_t, kSymbolTrieSize> symbol{}; // index in kSymbols, -1 if no symbol ends here
+};
+
+constexpr SymbolTrie BuildSymbolTrie() {
+  SymbolTrie trie;
+  for (size_t node = 0; node < kSymbolTrieSize; ++node)
+    trie.symbol[node] = -1;
+  size_t nodes = 1;
+  for (size_t i = 0; i < kSymbolCount; ++i) {
+    size_t node = 0;
+    for (char ch : kSymbols[i].text) {
+      auto & child = trie.next[node][static_cast<unsigned char>(ch)];
+      if (child == 0)
+        child = static_cast<uint8_t>(nodes++);
+      node = child;
+    }
+    trie.symbol[node] = static_cast<int8_t>(i);
+  }
+  return trie;
+}
+
+constexpr SymbolTrie kSymbolTrie = BuildSymbolTrie();
+
+// Maximal munch: index in kSymbols of the longest symbol at code[index], -1 if there is none
+int FindSymbol(std::string_view code, size_t index, size_t & length) {
+  int found = -1;
+  size_t node = 0;
+  for (size_t i = index; i < code.size() && static_cast<unsigned char>(code[i]) < 128; ++i) {
+    node = kSymbolTrie.next[node][static_cast<unsigned char>(code[i])];
+    if (node == 0) break;
+    if (kSymbolTrie.symbol[node] >= 0) {
+      found = kSymbolTrie.symbol[node];
+      length = i - index + 1;
+    }
+  }
+  return found;
+}
+
+// Symbols of words and operators are interned once
+std::vector<SymbolId> word_symbols, symbol_symbols;
+
+const std::map<char, std::string> backslash_chars = {
+  {'n', "\n"}, {'r', "\r"}, {'t', "\t"}, {'\\', "\\"}, {'\n', ""}, {'"', "\""}, {'\'', "'"}
+};
+
+bool InternLexemeStrings() {
+  for (const LexemeString & word : kWords)
+    word_symbols.push_back(InternSymbol(word.text));
+  for (const LexemeString & symbol : kSymbols)
+    symbol_symbols.push_back(InternSymbol(symbol.text));
+  return true;
+}
+
+Lexer::Lexer(std::string_view code, size_t position) : code_(code), position_(position) {
+  // Static initialization is thread-safe, lexers may be created by several threads
+  static const bool interned = InternLexemeStrings();
+  (void)interned;
+}
+
+Lexer::Lexer(const std::vector<Lexeme> & lexemes) : lexemes_(&lexemes) {}
+
+bool Lexer::GetNext(Lexeme & lexeme) {
+  if (lookahead_.empty())
+    return Scan(lexeme);
+  lexeme = lookahead_.front();
+  lookahead_.pop_front();
+  return true;
+}
+
+bool Lexer::Peek(size_t ahead, Lexeme & lexeme) {
+  while (lookahead_.size() <= ahead) {
+    Lexeme next;
+    if (!Scan(next)) return false;
+    lookahead_.push_back(next);
+  }
+  lexeme = lookahead_[ahead];
+  return true;
+}
+
+bool Lexer::Scan(Lexeme & lexeme) {
+  if (!timed_)
+    return ScanNext(lexeme);
+  auto start = std::chrono::steady_clock::now();
+  bool scanned = ScanNext(lexeme);
+  scan_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  return scanned;
+}
+
+bool Lexer::ScanNext(Lexeme & lexeme) {
+  if (lexemes_) {
+    if (position_ == lexemes_->size()) return false;
+    lexeme = (*lexemes_)[position_++];
+    return true;
+  }
+  std::string_view code = code_;
+  for (size_t i = position_, j = i + 1; i < code.size(); i = j++) {
+    if (IsSpaceChar(code[i])) {
+      j = SkipWhitespace(code, j);
       continue;
     }
 
-    if (Fits(code, i, L"//")) {                                   // comment
-      while (j < code.size() && code[j] != '\n')
-        ++j;
+    if (Fits(code, i, "/*")) {                                    // multi-line comment
+      size_t end = FindCommentEnd(code, j);
+      if (end == std::string_view::npos)
+        throw CommentNotEndedError(std::max(j, code.size() - 1));
+      j = end + 2;
       continue;
     }
 
-    std::wstring str;
-    str.push_back(code[i]);
+    if (Fits(code, i, "//")) {                                    // comment
+      j = std::min(code.find('\n', j), code.size());
+      continue;
+    }
 
-    if (std::isalpha(code[i]) || code[i] == '_') {                // identifier/reserved
-      while (j < code.size() && (std::isalpha(code[j]) || code[j] == L'_' || std::isdigit(code[j]))) {
-        str.push_back(code[j++]);
-      }
-      LexemeType resulting_type = LexemeType::kIdentifier;
-      for (const std::pair<std::wstring, LexemeType> & ovd : identifier_overrides) {
-        if (str == ovd.first) {
-          resulting_type = ovd.second;
+    size_t length = IdentifierCharLength(code, i, true);
+    if (length) {                                                 // identifier/reserved
+      j = i + length;
+      // ASCII runs are skipped at once, other characters one by one
+      while (true) {
+        j = SkipIdentifier(code, j);
+        if (j >= code.size() || !(length = IdentifierCharLength(code, j, false)))
           break;
-        }
+        j += length;
       }
-      result.emplace_back(resulting_type, str, i);
-    } else if (std::isdigit(code[i])) {                           // numeric literal
+      std::string_view word = code.substr(i, j - i);
+      int word_index = FindWord(word);
+      if (word_index >= 0)
+        lexeme = Lexeme(kWords[word_index].type, word_symbols[word_index], i);
+      else
+        lexeme = Lexeme(LexemeType::kIdentifier, InternSymbol(word), i);
+    } else if (IsDigitChar(code[i])) {                            // numeric literal
       bool is_hex = false;
       bool is_decimal = false;
-      if (Fits(code, i, L"0x")) {
+      if (Fits(code, i, "0x")) {
         is_hex = true;
         ++j;
-        str.push_back(L'x');
-      }
-      while (j < code.size() && IsDigit(code[j], is_hex)) {
-        str.push_back(code[j++]);
       }
+      size_t digits_begin = j + is_hex - 1;
+      if (is_hex) {
+        while (j < code.size() && IsDigit(code[j], is_hex))
+          ++j;
+        if (j == digits_begin)
+          throw NumberNotFinishedError(j);
+      } else
+        j = SkipDigits(code, j);
       if (j < code.size() && !is_hex && code[j] == '.') {
-        str.push_back(code[j++]);
-        if (j == code.size() || !std::isdigit(code[j]))
+        ++j;
+        if (j == code.size() || !IsDigitChar(code[j]))
           throw NumberNotFinishedError(j);
-        while (j < code.size() && std::isdigit(code[j]))
-          str.push_back(code[j++]);
+        j = SkipDigits(code, j);
         is_decimal = true;
       }
+      std::string_view digits = code.substr(digits_begin, j - digits_begin);
+      PrimitiveVariableType type = is_decimal ? PrimitiveVariableType::kF64 : PrimitiveVariableType::kInt32;
       if (j < code.size()) {
         if (is_decimal) {
-          if (code[j] == 'f' || code[j] == 'F')
-            str.push_back(code[j++]);
-        } else {
-          if (code[j] == 'u' || code[j] == 'U')
-            str.push_back(code[j++]);
-          if (j < code.size() &&
-              (code[j] == 'i' || code[j] == 'I' || code[j] == 'l' || code[j] == 'L' || code[j] == 's'
-                || code[j] == 'S' || code[j] == 't' || code[j] == 'T'))
-            str.push_back(code[j++]);
-        }
+          if (code[j] == 'f' || code[j] == 'F') {
+            type = PrimitiveVariableType::kF32;
+            ++j;
+          }
+        } else
+          j = IntegerSuffix(code, j, type);
       }
-      result.emplace_back(LexemeType::kNumericLiteral, str, i);
-    } else if (code[i] == L'"' || code[i] == L'\'') {
-      wchar_t quote = code[i];
-      str.pop_back();
+      bool has_suffix = i + (is_hex ? 2 : 0) + digits.size() != j;
+      uint64_t value = is_decimal ? DecodeDecimal(digits, type, i)
+                                  : DecodeInteger(digits, is_hex ? 16 : 10, has_suffix, type, i);
+      lexeme = Lexeme(LexemeType::kNumericLiteral, code.substr(i, j - i), i, type, value);
+    } else if (code[i] == '"' || code[i] == '\'') {
+      char quote = code[i];
+      std::string str;
 
-      while (j < code.size() && code[j] != quote && code[j] != L'\n') {
-        if (code[j] == L'\\') {
+      while (true) {
+        size_t special = FindStringSpecial(code, j, quote);
+        str.append(code.substr(j, special - j));
+        j = special;
+        if (j >= code.size() || code[j] == quote || code[j] == '\n')
+          break;
+        if (code[j] == '\\') {
           if (j + 1 == code.size() || !backslash_chars.count(code[j+1]))
             throw UnknownEscapeSequenceError(j + 1);
-          str += backslash_chars[code[j+1]];
+          str += backslash_chars.at(code[j+1]);
           j += 2;
-        } else
-          str.push_back(code[j++]);
+        } else {
+          // literals keep UTF-8 bytes as they are
+          size_t char_length = Utf8SequenceLength(code, j);
+          if (char_length == 0)
+            throw InvalidUtf8Error(j);
+          str.append(code.substr(j, char_length));
+          j += char_length;
+        }
       }
 
-      if (quote == L'"') {
-        if (j >= code.size() || code[j] == L'\n')
+      if (quote == '"') {
+        if (j >= code.size() || code[j] == '\n')
           throw StringNotEndedError(j);
-        result.emplace_back(LexemeType::kStringLiteral, str, i);
+        lexeme = Lexeme(LexemeType::kStringLiteral, str, i);
       } else {
-        if (j >= code.size() || code[j] == L'\n' || str.size() != 1)
+        if (j >= code.size() || code[j] == '\n' || str.size() != 1)
           throw CharIncorrectUsageError(j);
-        result.emplace_back(LexemeType::kCharLiteral, str, i);
+        lexeme = Lexeme(LexemeType::kCharLiteral, str, i, PrimitiveVariableType::kChar,
+                        static_cast<unsigned char>(str[0]));
       }
       ++j;
     } else {
 
-      bool found = false;
-      for (size_t len = std::min(by_length.size() - 1, code.size() - i); len > 0; --len) {
-        for (const auto & [word, type] : by_length[len]) {
-          if (Fits(code, i, word)) {
-            found = true;
-            result.emplace_back(type, word, i);
-            j = i + len;
-            break;
-          }
-        }
-        if (found) break;
+      int symbol_index = FindSymbol(code, i, length);
+      if (symbol_index >= 0) {
+        lexeme = Lexeme(kSymbols[symbol_index].type, symbol_symbols[symbol_index], i);
+        j = i + length;
+      } else {
+        length = Utf8SequenceLength(code, i);
+        if (length == 0)
+          throw InvalidUtf8Error(i);
+        j = i + length;
+        lexeme = Lexeme(LexemeType::kUnknown, code.substr(i, length), i);
       }
-      if (!found) {
-        result.emplace_back(LexemeType::kUnknown, str, i);
+
+    }
+    position_ = j;
+    return true;
+  }
+  position_ = code.size();
+  return false;
+}
+
+// Part of source lexed speculatively as if no comment or string crossed its beginning
+struct LexedChunk {
+  size_t begin;
+  size_t end;
+  std::vector<Lexeme> lexemes;  // ones starting before end
+  bool has_next = false;        // next is the first lexeme starting at or after end
+  Lexeme next;
+  std::exception_ptr error;     // lexing stopped at error after lexemes
+};
+
+void LexChunk(std::string_view code, LexedChunk & chunk) {
+  try {
+    Lexer lexer(code, chunk.begin);
+    Lexeme lexeme;
+    while (lexer.GetNext(lexeme)) {
+      if (lexeme.GetIndex() >= chunk.end) {
+        chunk.has_next = true;
+        chunk.next = lexeme;
+        return;
       }
+      chunk.lexemes.push_back(lexeme);
+    }
+  } catch (...) {
+    chunk.error = std::current_exception();
+  }
+}
+
+// Chunks end right after newlines, so only /* */ comments and strings with escaped newlines cross them
+std::vector<LexedChunk> SplitIntoChunks(std::string_view code, size_t count) {
+  std::vector<LexedChunk> chunks;
+  size_t begin = 0;
+  for (size_t k = 1; k <= count && begin < code.size(); ++k) {
+    size_t end = code.size();
+    if (k < count) {
+      end = code.find('\n', std::max(begin, code.size() / count * k));
+      end = end == std::string_view::npos ? code.size() : end + 1;
+    }
+    chunks.push_back({ begin, end, {}, false, {}, nullptr });
+    begin = end;
+  }
+  return chunks;
+}
+
+// Lexing is deterministic from the beginning of a lexeme: once the true stream produces lexeme
+// at the same index as speculative one, the rest of speculative chunk is the true stream as well
+std::vector<Lexeme> MergeChunks(std::string_view code, std::vector<LexedChunk> & chunks) {
+  std::vector<Lexeme> result;
+  Lexeme pending(LexemeType::kNull, kEmptySymbol, 0);  // next lexeme of the true stream
+  bool has_pending = true;
+  for (LexedChunk & chunk : chunks) {
+    if (!has_pending) break;
+    if (pending.GetIndex() >= chunk.end) continue;
+
+    auto by_index = [](const Lexeme & lexeme, size_t index) { return lexeme.GetIndex() < index; };
+    auto it = std::lower_bound(chunk.lexemes.begin(), chunk.lexemes.end(), pending.GetIndex(), by_index);
+    bool synchronized = &chunk == &chunks.front();
+    if (!synchronized && (it == chunk.lexemes.end() || it->GetIndex() != pending.GetIndex())) {
+      // Speculative start was wrong, true stream is lexed until it meets speculative one
+      Lexer lexer(code, pending.GetIndex());
+      Lexeme lexeme;
+      has_pending = false;
+      while (lexer.GetNext(lexeme)) {
+        if (lexeme.GetIndex() >= chunk.end) {
+          has_pending = true;
+          pending = lexeme;
+          break;
+        }
+        it = std::lower_bound(it, chunk.lexemes.end(), lexeme.GetIndex(), by_index);
+        if (it != chunk.lexemes.end() && it->GetIndex() == lexeme.GetIndex()) {
+          synchronized = true;
+          break;
+        }
+        result.push_back(lexeme);
+      }
+    } else
+      synchronized = true;
+
+    if (synchronized) {
+      result.insert(result.end(), it, chunk.lexemes.end());
+      if (chunk.error)
+        std::rethrow_exception(chunk.error);
+      has_pending = chunk.has_next;
+      pending = chunk.next;
+    }
+  }
+  return result;
+}
+
+std::vector<Lexeme> PerformLexicalAnalysis(std::string_view code, unsigned threads) {
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, code.size() / kMinParallelChunkSize + 1));
+  }
+  if (threads == 1) {
+    Lexer lexer(code);
+    std::vector<Lexeme> result;
+    Lexeme lexeme;
+    while (lexer.GetNext(lexeme))
+      result.push_back(lexeme);
+    return result;
+  }
+
+  // Several chunks per thread, so a thread which lexed a cheap chunk takes another one
+  std::vector<LexedChunk> chunks = SplitIntoChunks(code, threads * 4);
+  std::atomic<size_t> next_chunk = 0;
+  auto worker = [&]() {
+    for (size_t k = next_chunk++; k < chunks.size(); k = next_chunk++)
+      LexChunk(code, chunks[k]);
+  };
+  SetSymbolsShared(true);
+  std::vector<std::thread> pool;
+  for (unsigned k = 1; k < threads; ++k)
+    pool.emplace_back(worker);
+  worker();
+  for (std::thread & thread : pool)
+    thread.join();
+  SetSymbolsShared(false);
+  return MergeChunks(code, chunks);
+}
 
+std::vector<Lexeme> RelexAfterEdit(const std::vector<Lexeme> & lexemes, std::string_view code, const TextEdit & edit) {
+  auto by_index = [](const Lexeme & lexeme, size_t index) { return lexeme.GetIndex() < index; };
+  auto shifted = [&edit](const Lexeme & lexeme) {
+    return lexeme.WithIndex(lexeme.GetIndex() + edit.inserted.size() - edit.removed);
+  };
+
+  // The last lexeme before the edit is lexed again, edit may continue it or make a comment of it;
+  // without one edit may have been in a comment before the first lexeme
+  auto kept = std::lower_bound(lexemes.begin(), lexemes.end(), edit.offset, by_index);
+  size_t start = 0;
+  if (kept != lexemes.begin())
+    start = (--kept)->GetIndex();
+  std::vector<Lexeme> result(lexemes.begin(), kept);
+
+  // Old lexemes which may be met: they start after the removed bytes
+  size_t edit_end = edit.offset + edit.inserted.size();
+  auto old = std::lower_bound(kept, lexemes.end(), edit.offset + edit.removed, by_index);
+  Lexer lexer(code, start);
+  Lexeme lexeme;
+  while (lexer.GetNext(lexeme)) {
+    if (lexeme.GetIndex() >= edit_end) {
+      // Bytes from here are the same as from old_index before the edit, so are lexemes
+      size_t old_index = lexeme.GetIndex() - edit.inserted.size() + edit.removed;
+      old = std::lower_bound(old, lexemes.end(), old_index, by_index);
+      if (old != lexemes.end() && old->GetIndex() == old_index) {
+        for (; old != lexemes.end(); ++old)
+          result.push_back(shifted(*old));
+        return result;
+      }
     }
+    result.push_back(lexeme);
   }
   return result;
 }
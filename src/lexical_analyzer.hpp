@@ -1,6 +1,51 @@
 #pragma once
 
 #include "lexeme.hpp"
+#include <deque>
+#include <string>
+#include <string_view>
 #include <vector>
 
-std::vector<Lexeme> PerformLexicalAnalysis(const std::wstring & code);
+// Scans UTF-8 source lexeme by lexeme as they are pulled, only lookahead is kept;
+// indices of lexemes are byte offsets in source
+class Lexer {
+ public:
+  explicit Lexer(std::string_view code, size_t position = 0);
+  explicit Lexer(const std::vector<Lexeme> & lexemes); // replays lexemes lexed before, they have to outlive lexer
+
+  bool GetNext(Lexeme & lexeme);              // false when source is over
+  bool Peek(size_t ahead, Lexeme & lexeme);   // lexeme after the next ahead ones, not consumed
+
+  // Time spent scanning is accumulated only while timed, clock is read around every lexeme
+  void SetTimed(bool timed) { timed_ = timed; }
+  int64_t GetScanNanoseconds() const { return scan_ns_; }
+
+ private:
+  bool Scan(Lexeme & lexeme);
+  bool ScanNext(Lexeme & lexeme);
+
+  std::string_view code_;
+  size_t position_ = 0;
+  const std::vector<Lexeme> * lexemes_ = nullptr;
+  std::deque<Lexeme> lookahead_;
+  bool timed_ = false;
+  int64_t scan_ns_ = 0;
+};
+
+// Automatic parallel lexing gives each thread at least that much source
+constexpr size_t kMinParallelChunkSize = 1 << 18;
+
+// Whole source at once, for tools which need all lexemes; with several threads (0 means one per core)
+// source is split into chunks at newlines, result is the same as of sequential lexing
+std::vector<Lexeme> PerformLexicalAnalysis(std::string_view code, unsigned threads = 1);
+
+// Replacement of removed bytes at offset by inserted ones
+struct TextEdit {
+  size_t offset;
+  size_t removed;
+  std::string inserted;
+};
+
+// Lexemes of edited source given lexemes of source before the edit: only lexemes around the edit
+// are lexed again until they meet old ones, the rest are old ones shifted by the edit
+std::vector<Lexeme> RelexAfterEdit(const std::vector<Lexeme> & lexemes, std::string_view code, const TextEdit & edit);
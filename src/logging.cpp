@@ -1,31 +1,82 @@
 #include "logging.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <sstream>
+#include <vector>
 
 #include "exceptions.hpp"
 #include "operators.hpp"
 #include "warnings.hpp"
 #include "lexeme.hpp"
 #include "terminal_formatting.hpp"
+#include "source.hpp"
 
-std::wstring code_;
+std::string_view code_;
+std::vector<size_t> lineStarts_; // byte offset of every line in code_
 std::map<std::string, std::string> options_;
 
+// Diagnostic is composed here and written to std::wcout at once, without flushing it
+std::wostringstream out_;
+
 int64_t warningsNum = 0;
 
-void log::init(const std::wstring &code, const std::map<std::string, std::string> & options) {
+void log::init(std::string_view code, const std::map<std::string, std::string> & options) {
   code_ = code;
   options_ = options;
+  lineStarts_.assign(1, 0);
+  for (const char * newline = code.data();
+       (newline = static_cast<const char *>(std::memchr(newline, '\n', code.data() + code.size() - newline)));)
+    lineStarts_.push_back(static_cast<size_t>(++newline - code.data()));
+}
+
+// Index is byte offset in UTF-8 code; lines and columns are 1-based, column is counted in characters
+void FindPosition(size_t index, size_t & lineIndex, size_t & columnIndex, size_t & lineStartIndex) {
+  index = std::min(index, code_.size());
+  auto line = std::upper_bound(lineStarts_.begin(), lineStarts_.end(), index) - 1;
+  lineIndex = static_cast<size_t>(line - lineStarts_.begin()) + 1;
+  lineStartIndex = *line;
+  columnIndex = 1;
+  for (size_t i = lineStartIndex; i < index; ++i)
+    if ((static_cast<unsigned char>(code_[i]) & 0xC0) != 0x80)
+      ++columnIndex;
+}
+
+// Writes composed diagnostic out
+void flushDiagnostic() {
+  std::wcout << out_.str();
+  out_.str(L"");
+}
+
+// Prints line starting at lineStart, highlighting bytes [index, index + size)
+template <typename Color>
+void printLine(size_t lineStart, size_t index, size_t size, Color highlight) {
+  bool highlighted = false;
+  for (size_t i = lineStart; i < code_.size() && code_[i] != '\n';) {
+    size_t length = std::max<size_t>(Utf8SequenceLength(code_, i), 1);
+    if (!highlighted && index < i + length && i < index + size) {
+      out_ << highlight << color::white;
+      highlighted = true;
+    }
+    out_ << DecodeUtf8(code_, i, length);
+    i += length;
+    if (highlighted && i >= index + size) {
+      out_ << format::reset;
+      highlighted = false;
+    }
+  }
+  if (highlighted) out_ << format::reset;
 }
 
 void printUnexpectedLexeme(const TranslatorError &err) {
   const UnexpectedLexeme *error = dynamic_cast<const UnexpectedLexeme *>(&err);
   if (error == nullptr) return;
 
-  std::wcout << format::bright << " (" << format::reset;
-  std::wcout << format::bright << "expected: " << color::cyan << ToString(error->GetExpected()) << format::reset;
-  std::wcout << format::bright << ", got: " << color::red << ToString(error->GetActual().GetType()) << format::reset;
-  std::wcout << format::bright << ')' << format::reset;
+  out_ << format::bright << " (" << format::reset;
+  out_ << format::bright << "expected: " << color::cyan << ToString(error->GetExpected()) << format::reset;
+  out_ << format::bright << ", got: " << color::red << ToString(error->GetActual().GetType()) << format::reset;
+  out_ << format::bright << ')' << format::reset;
 }
 
 void printUnknownOperator(const TranslatorError &err) {
@@ -35,55 +86,55 @@ void printUnknownOperator(const TranslatorError &err) {
   Operator op = error->GetOperator();
   switch (op.GetOperatorType()) {
     case OperatorType::kUnaryPrefix:
-      std::wcout << format::bright << " (" << format::reset;
+      out_ << format::bright << " (" << format::reset;
       if (error->GetValue()->GetValueType() == TIDValueType::kVariable) {
         const TIDVariable var = dynamic_cast<const TIDVariable &>(*error->GetValue());
-        std::wcout << format::bright << color::blue << var.GetName() << " " << format::reset << format::bright << format::reset;
-        std::wcout << format::bright << color::red << var.GetType()->ToString() << format::reset;
+        out_ << format::bright << color::blue << var.GetName() << " " << format::reset << format::bright << format::reset;
+        out_ << format::bright << color::red << var.GetType()->ToString() << format::reset;
       }
       else {
-        std::wcout << format::bright << color::blue << format::italic << "temp " << format::reset << format::bright << format::reset;
-        std::wcout << format::bright << color::red << error->GetValue()->GetType()->ToString() << format::reset;
+        out_ << format::bright << color::blue << format::italic << "temp " << format::reset << format::bright << format::reset;
+        out_ << format::bright << color::red << error->GetValue()->GetType()->ToString() << format::reset;
       }
-      std::wcout << format::bright << " " << color::red << op.ToString() << format::reset;
-      std::wcout << format::bright << ')' << format::reset;
+      out_ << format::bright << " " << color::red << op.ToString() << format::reset;
+      out_ << format::bright << ')' << format::reset;
       break;
     case OperatorType::kUnaryPostfix:
-      std::wcout << format::bright << " (" << format::reset;
-      std::wcout << format::bright << color::red << op.ToString() << " " << format::reset;
+      out_ << format::bright << " (" << format::reset;
+      out_ << format::bright << color::red << op.ToString() << " " << format::reset;
       if (error->GetValue()->GetValueType() == TIDValueType::kVariable) {
         const TIDVariable var = dynamic_cast<const TIDVariable &>(*error->GetValue());
-        std::wcout << format::bright << color::blue << var.GetName() << " " << format::reset << format::bright << format::reset;
-        std::wcout << format::bright << color::red << var.GetType()->ToString() << format::reset;
+        out_ << format::bright << color::blue << var.GetName() << " " << format::reset << format::bright << format::reset;
+        out_ << format::bright << color::red << var.GetType()->ToString() << format::reset;
       }
       else {
-        std::wcout << format::bright << color::blue << format::italic << "temp " << format::reset << format::bright << format::reset;
-        std::wcout << format::bright << color::red << error->GetValue()->GetType()->ToString() << format::reset;
+        out_ << format::bright << color::blue << format::italic << "temp " << format::reset << format::bright << format::reset;
+        out_ << format::bright << color::red << error->GetValue()->GetType()->ToString() << format::reset;
       }
-      std::wcout << format::bright << ')' << format::reset;
+      out_ << format::bright << ')' << format::reset;
       break;
     case OperatorType::kBinary:
-      std::wcout << format::bright << " (" << format::reset;
+      out_ << format::bright << " (" << format::reset;
       if (error->GetLHSValue()->GetValueType() == TIDValueType::kVariable) {
         const TIDVariable var = dynamic_cast<const TIDVariable &>(*error->GetLHSValue());
-        std::wcout << format::bright << color::blue << var.GetName() << " " << format::reset << format::bright << format::reset;
-        std::wcout << format::bright << color::red << var.GetType()->ToString() << format::reset;
+        out_ << format::bright << color::blue << var.GetName() << " " << format::reset << format::bright << format::reset;
+        out_ << format::bright << color::red << var.GetType()->ToString() << format::reset;
       }
       else {
-        std::wcout << format::bright << color::blue << format::italic << "temp " << format::reset << format::bright << format::reset;
-        std::wcout << format::bright << color::red << error->GetLHSValue()->GetType()->ToString() << format::reset;
+        out_ << format::bright << color::blue << format::italic << "temp " << format::reset << format::bright << format::reset;
+        out_ << format::bright << color::red << error->GetLHSValue()->GetType()->ToString() << format::reset;
       }
-      std::wcout << format::bright << " " << color::red << op.ToString() << " " << format::reset;
+      out_ << format::bright << " " << color::red << op.ToString() << " " << format::reset;
       if (error->GetRHSValue()->GetValueType() == TIDValueType::kVariable) {
         const TIDVariable var = dynamic_cast<const TIDVariable &>(*error->GetRHSValue());
-        std::wcout << format::bright << color::blue << var.GetName() << " " << format::reset << format::bright << format::reset;
-        std::wcout << format::bright << color::red << var.GetType()->ToString() << format::reset;
+        out_ << format::bright << color::blue << var.GetName() << " " << format::reset << format::bright << format::reset;
+        out_ << format::bright << color::red << var.GetType()->ToString() << format::reset;
       }
       else {
-        std::wcout << format::bright << color::blue << format::italic << "temp " << format::reset << format::bright << format::reset;
-        std::wcout << format::bright << color::red << error->GetRHSValue()->GetType()->ToString() << format::reset;
+        out_ << format::bright << color::blue << format::italic << "temp " << format::reset << format::bright << format::reset;
+        out_ << format::bright << color::red << error->GetRHSValue()->GetType()->ToString() << format::reset;
       }
-      std::wcout << format::bright << ')' << format::reset;
+      out_ << format::bright << ')' << format::reset;
       break;
   };
 }
@@ -92,73 +143,67 @@ void printTypeMismatch(const TranslatorError &err) {
   const TypeMismatch *error = dynamic_cast<const TypeMismatch *>(&err);
   if (error == nullptr) return;
 
-  std::wcout << format::bright << " (" << format::reset;
-  std::wcout << format::bright << "expected: " << color::cyan << error->GetTypeExpected()->ToString() << format::reset;
-  std::wcout << format::bright << ", got: " << color::red << error->GetTypeGot()->ToString() << format::reset;
-  std::wcout << format::bright << ')' << format::reset;
+  out_ << format::bright << " (" << format::reset;
+  out_ << format::bright << "expected: " << color::cyan << error->GetTypeExpected()->ToString() << format::reset;
+  out_ << format::bright << ", got: " << color::red << error->GetTypeGot()->ToString() << format::reset;
+  out_ << format::bright << ')' << format::reset;
 }
 
 void printFunctionParameterListDoesNotMatch(const TranslatorError &err) {
   const FunctionParameterListDoesNotMatch *error = dynamic_cast<const FunctionParameterListDoesNotMatch *>(&err);
   if (error == nullptr) return;
 
-  std::wcout << format::bright << " (" << format::reset;
-  std::wcout << format::bright << "expected: " << color::cyan;
+  out_ << format::bright << " (" << format::reset;
+  out_ << format::bright << "expected: " << color::cyan;
   if (error->GetFunctionType()->GetParameters().size() == 0 && error->GetFunctionType()->GetDefaultParameters().size()) {
-    std::wcout << "nothing";
+    out_ << "nothing";
   }
   else if (error->GetFunctionType()->GetParameters().size() > 0) {
-    std::wcout << error->GetFunctionType()->GetParameters()[0]->ToString();
+    out_ << error->GetFunctionType()->GetParameters()[0]->ToString();
     for (size_t i = 1; i < error->GetFunctionType()->GetParameters().size(); ++i) {
-      std::wcout << ", " << error->GetFunctionType()->GetParameters()[i]->ToString();
+      out_ << ", " << error->GetFunctionType()->GetParameters()[i]->ToString();
     }
-    std::wcout << format::italic;
+    out_ << format::italic;
     for (size_t i = 0; i < error->GetFunctionType()->GetDefaultParameters().size(); ++i) {
-      std::wcout << ", " << error->GetFunctionType()->GetDefaultParameters()[i]->ToString();
+      out_ << ", " << error->GetFunctionType()->GetDefaultParameters()[i]->ToString();
     }
   }
   else {
-    std::wcout << format::italic;
-    std::wcout << error->GetFunctionType()->GetDefaultParameters()[0]->ToString();
+    out_ << format::italic;
+    out_ << error->GetFunctionType()->GetDefaultParameters()[0]->ToString();
     for (size_t i = 1; i < error->GetFunctionType()->GetDefaultParameters().size(); ++i) {
-      std::wcout << ", " << error->GetFunctionType()->GetDefaultParameters()[i]->ToString();
+      out_ << ", " << error->GetFunctionType()->GetDefaultParameters()[i]->ToString();
     }
   }
-  std::wcout << format::reset;
+  out_ << format::reset;
 
-  std::wcout << format::bright << ", got: " << color::red;
+  out_ << format::bright << ", got: " << color::red;
   if (error->GetProvided().size() == 0) {
-    std::wcout << "nothing";
+    out_ << "nothing";
   }
   else {
-    std::wcout << error->GetProvided()[0]->ToString();
+    out_ << error->GetProvided()[0]->ToString();
     for (size_t i = 1; i < error->GetProvided().size(); ++i) {
-      std::wcout << ", " << error->GetProvided()[i]->ToString();
+      out_ << ", " << error->GetProvided()[i]->ToString();
     }
   }
-  std::wcout << format::reset;
-  std::wcout << format::bright << ')' << format::reset;
+  out_ << format::reset;
+  out_ << format::bright << ')' << format::reset;
 }
 
 void log::error(const TranslatorError &error) {
   // Getting position in file
-  size_t lineIndex = 1, columnIndex = 0, lineStartIndex = 0;
-  for (size_t i = 0; i < error.GetIndex(); ++i, ++columnIndex) {
-    if (code_[i] == '\n') {
-      columnIndex = 0;
-      ++lineIndex;
-      lineStartIndex = i + 1;
-    }
-  }
+  size_t lineIndex, columnIndex, lineStartIndex;
+  FindPosition(error.GetIndex(), lineIndex, columnIndex, lineStartIndex);
 
   // Printing error info
-  std::wcout << format::bright << lineIndex << ':' << columnIndex << ": ";
-  std::wcout << color::red << "error: " << format::reset << format::bright << error.what() << format::reset;
+  out_ << format::bright << lineIndex << ':' << columnIndex << ": ";
+  out_ << color::red << "error: " << format::reset << format::bright << error.what() << format::reset;
   printUnexpectedLexeme(error);
   printUnknownOperator(error);
   printTypeMismatch(error);
   printFunctionParameterListDoesNotMatch(error);
-  std::wcout << std::endl;
+  out_ << L'\n';
 
   // Getting error lexeme type
   size_t lexemeSize = 1;
@@ -171,12 +216,9 @@ void log::error(const TranslatorError &error) {
   }
 
   // Printing line with error
-  for (size_t i = lineStartIndex; i < code_.size() && code_[i] != '\n'; ++i) {
-    if (i == error.GetIndex()) std::wcout << color::background::red << color::white;
-    std::wcout << code_[i];
-    if (i == error.GetIndex() + lexemeSize - 1) std::wcout << format::reset;
-  }
-  std::wcout << std::endl << std::endl;
+  printLine(lineStartIndex, error.GetIndex(), lexemeSize, color::background::red);
+  out_ << L"\n\n";
+  flushDiagnostic();
 }
 
 
@@ -184,30 +226,24 @@ void printDowncast(const TranslatorWarning &warn) {
   const Downcast *warning = dynamic_cast<const Downcast *>(&warn);
   if (warning == nullptr) return;
 
-  std::wcout << format::bright << " (" << format::reset;
-  std::wcout << format::bright << "from: " << color::blue << warning->GetFrom()->ToString() << format::reset;
-  std::wcout << format::bright << ", to: " << color::red << warning->GetTo()->ToString() << format::reset;
-  std::wcout << format::bright << ')' << format::reset;
+  out_ << format::bright << " (" << format::reset;
+  out_ << format::bright << "from: " << color::blue << warning->GetFrom()->ToString() << format::reset;
+  out_ << format::bright << ", to: " << color::red << warning->GetTo()->ToString() << format::reset;
+  out_ << format::bright << ')' << format::reset;
 }
 
 void log::warning(const TranslatorWarning &warning) {
   if (options_["disableWarnings"] == "true") return;
 
   // Getting position in file
-  size_t lineIndex = 1, columnIndex = 0, lineStartIndex = 0;
-  for (size_t i = 0; i < warning.GetIndex(); ++i, ++columnIndex) {
-    if (code_[i] == '\n') {
-      columnIndex = 0;
-      ++lineIndex;
-      lineStartIndex = i + 1;
-    }
-  }
+  size_t lineIndex, columnIndex, lineStartIndex;
+  FindPosition(warning.GetIndex(), lineIndex, columnIndex, lineStartIndex);
 
   // Printing warning info
-  std::wcout << format::bright << lineIndex << ':' << columnIndex << ": ";
-  std::wcout << color::blue << "warning: " << format::reset << format::bright << warning.what() << format::reset;
+  out_ << format::bright << lineIndex << ':' << columnIndex << ": ";
+  out_ << color::blue << "warning: " << format::reset << format::bright << warning.what() << format::reset;
   printDowncast(warning);
-  std::wcout << std::endl;
+  out_ << L'\n';
 
   // Getting warning lexeme type
   size_t lexemeSize = 1;
@@ -220,12 +256,9 @@ void log::warning(const TranslatorWarning &warning) {
   }
 
   // Printing line with warning
-  for (size_t i = lineStartIndex; i < code_.size() && code_[i] != '\n'; ++i) {
-    if (i == warning.GetIndex()) std::wcout << color::background::blue << color::white;
-    std::wcout << code_[i];
-    if (i == warning.GetIndex() + lexemeSize - 1) std::wcout << format::reset;
-  }
-  std::wcout << std::endl << std::endl;
+  printLine(lineStartIndex, warning.GetIndex(), lexemeSize, color::background::blue);
+  out_ << L"\n\n";
+  flushDiagnostic();
   ++warningsNum;
 }
 
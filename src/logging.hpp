@@ -3,8 +3,11 @@
 #include "exceptions.hpp"
 #include "warnings.hpp"
 
+#include <string_view>
+
 namespace log {
-  void init(const std::wstring & code, const std::map<std::string, std::string> & options = {
+  // Code is UTF-8 source, it has to outlive logging
+  void init(std::string_view code, const std::map<std::string, std::string> & options = {
       {"disableWarnings", "false"}
   });
 
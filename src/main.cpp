@@ -1,12 +1,14 @@
 #include <iostream>
 #include <cstdlib>
 #include <string>
-#include <fstream>
+#include <memory>
+#include <chrono>
 
 #include "TID.hpp"
 #include "generation.hpp"
 #include "lexeme.hpp"
 #include "lexical_analyzer.hpp"
+#include "source.hpp"
 #include "logging.hpp"
 #include "syntax_analyzer.hpp"
 #include "exceptions.hpp"
@@ -19,6 +21,10 @@ std::map<std::string, std::string> options = {
     {"compileFile",     ""},
     {"outFile",         "out.bbl"},
     {"runFile",         ""},
+    {"quiet",           "false"},
+    {"timings",         "false"},
+    {"unbuffered",      "false"},
+    {"reuseReadBuffers", "false"},
 };
 
 void ParseArgs(const int argc, const char *argv[]) {
@@ -41,15 +47,31 @@ void ParseArgs(const int argc, const char *argv[]) {
     else if (strcmp(argv[i], "--disableWarnings") == 0) {
       options["disableWarnings"] = "true";
     }
+    else if (strcmp(argv[i], "-q") == 0 || strcmp(argv[i], "--quiet") == 0) {
+      options["quiet"] = "true";
+    }
+    else if (strcmp(argv[i], "--timings") == 0) {
+      options["timings"] = "true";
+    }
+    else if (strcmp(argv[i], "-u") == 0 || strcmp(argv[i], "--unbuffered") == 0) {
+      options["unbuffered"] = "true";
+    }
+    else if (strcmp(argv[i], "--reuseReadBuffers") == 0) {
+      options["reuseReadBuffers"] = "true";
+    }
   }
 }
 
 void PrintHelp() {
-	std::wcout << "Usage: bblc [-c | --compile <path>] [-o | --out <path>] [-r | --run <path>] [--disableWarnings]" << std::endl << std::endl;
+	std::wcout << "Usage: bblc [-c | --compile <path>] [-o | --out <path>] [-r | --run <path>] [--disableWarnings] [-q | --quiet] [--timings] [-u | --unbuffered] [--reuseReadBuffers]" << std::endl << std::endl;
   std::wcout << format::bright << "-c | --compile <path>" << format::reset << "   Compiling file given in <path>" << std::endl;
   std::wcout << format::bright << "-o | --out <path>" << format::reset << "       Writes compiled file in <path>" << std::endl;
   std::wcout << format::bright << "-r | --run <path>" << format::reset << "       Running file given in <path>" << std::endl;
   std::wcout << format::bright << "--disableWarnings" << format::reset << "       Disables all the warning during compilation" << std::endl;
+  std::wcout << format::bright << "-q | --quiet" << format::reset << "            Prints only output of the program (and errors)" << std::endl;
+  std::wcout << format::bright << "--timings" << format::reset << "               Prints time spent in each phase to stderr" << std::endl;
+  std::wcout << format::bright << "-u | --unbuffered" << format::reset << "       Sends output of the program to stdout immediately" << std::endl;
+  std::wcout << format::bright << "--reuseReadBuffers" << format::reset << "      read() overwrites array in variable if it fits the line" << std::endl;
   std::wcout << std::endl;
 }
 
@@ -66,6 +88,25 @@ std::vector<std::string> split(std::string str, const std::string & delimiter) {
   return result;
 }
 
+// Time spent in each phase, in nanoseconds
+std::vector<std::pair<std::string, int64_t>> timings;
+
+template <typename Func>
+auto Timed(const std::string & phase, Func func) {
+  auto start = std::chrono::steady_clock::now();
+  auto result = func();
+  auto duration = std::chrono::steady_clock::now() - start;
+  timings.emplace_back(phase, std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+  return result;
+}
+
+void PrintTimings() {
+  if (options["timings"] != "true") return;
+  std::wcout.flush();
+  for (const auto & [phase, ns] : timings)
+    std::wcerr << L"timing " << phase << L' ' << ns << std::endl;
+}
+
 #define RPN_EXECUTING_TESTING 0
 
 int32_t main(const int argc, const char *argv[]) {
@@ -93,31 +134,28 @@ int32_t main(const int argc, const char *argv[]) {
   }
   ParseArgs(argc, argv);
 
-  std::wifstream codeFile;
-  codeFile.open(options["compileFile"]);
-  if (!codeFile.is_open()) {
+  std::unique_ptr<SourceFile> source = Timed("load", []() {
+    return std::make_unique<SourceFile>(options["compileFile"]);
+  });
+  if (!source->IsOpen()) {
     std::wcout << format::bright << color::red << "Cannot open file " << format::reset;
     std::cout << options["compileFile"] << std::endl;
     return 1;
   }
-
-  std::wstring code;
-  std::wstring line;
-  while (std::getline(codeFile, line)) {
-    code += line;
-    code.push_back(L'\n');
-  }
-  codeFile.close();
+  std::string_view code = source->GetText();
   log::init(code, options);
+  bool quiet = options["quiet"] == "true";
 
   RPN rpn;
 
   try {
-    std::vector<Lexeme> lexemes = PerformLexicalAnalysis(code);
-    for (Lexeme lexeme : lexemes)
-      if (lexeme.GetType() == LexemeType::kUnknown)
-        throw UnknownLexeme(lexeme.GetIndex(), lexeme.GetValue());
-    rpn = PerformSyntaxAnalysis(lexemes);
+    // Lexing is overlapped with parsing, time spent in lexer is taken out of "parse"
+    Lexer lexer(code);
+    lexer.SetTimed(options["timings"] == "true");
+    Timed("parse", [&lexer]() { PerformSyntaxAnalysis(lexer); return 0; });
+    timings.back().second -= lexer.GetScanNanoseconds();
+    timings.emplace(timings.end() - 1, "lex", lexer.GetScanNanoseconds());
+    rpn = Timed("link", []() { return PerformLinking(); });
   }
   catch (const TranslatorError & e) {
     log::error(e);
@@ -133,15 +171,21 @@ int32_t main(const int argc, const char *argv[]) {
     std::wcout << "Something went wrong. We are sorry about it" << std::endl;
     return 4;
   }
-  std::wcout << format::bright << color::green << '0' << format::reset << " error(s) were found" << std::endl;
-  std::wcout << format::bright << color::blue << log::getWarningsNum() << format::reset << " warning(s) were generated" << std::endl;
-  std::wcout << std::endl << "Generated RPN:" << std::endl;
-  size_t ind = 0;
-  for (auto x : rpn.GetNodes())
-    std::wcout << ind++ << L": " << x->ToString() << std::endl;
-  std::wcout << std::endl << "Executing:" << std::endl;
-  int32_t ret_code = Execute(rpn);
-  std::wcout << L"Return code: " << std::to_wstring(ret_code) << std::endl;
+  if (!quiet) {
+    std::wcout << format::bright << color::green << '0' << format::reset << " error(s) were found" << std::endl;
+    std::wcout << format::bright << color::blue << log::getWarningsNum() << format::reset << " warning(s) were generated" << std::endl;
+    std::wcout << std::endl << "Generated RPN:" << std::endl;
+    size_t ind = 0;
+    for (auto x : rpn.GetNodes())
+      std::wcout << ind++ << L": " << x->ToString() << std::endl;
+    std::wcout << std::endl << "Executing:" << std::endl;
+  }
+  run::unbuffered_output = options["unbuffered"] == "true";
+  run::reuse_read_buffers = options["reuseReadBuffers"] == "true";
+  int32_t ret_code = Timed("exec", [&rpn]() { return Execute(rpn); });
+  if (!quiet)
+    std::wcout << L"Return code: " << std::to_wstring(ret_code) << std::endl;
+  PrintTimings();
 
   return 0;
-}
\ No newline at end of file
+}
@@ -11,6 +11,7 @@ typedef std::pair<TIDValueType, std::shared_ptr<TIDVariableType>> VariableTypeWi
 constexpr TIDValueType value_types[] = { TIDValueType::kTemporary, TIDValueType::kVariable };
 
 std::map<VariableTypeWithValue, std::shared_ptr<TIDVariableType>> unary_operations[kUnaryPrefixOperatorCount + kUnaryPostfixOperatorCount];
+std::map<VariableTypeWithValue, std::shared_ptr<TIDVariableType>> bit_operations;
 
 constexpr PrimitiveVariableType numeric[] = {
   PrimitiveVariableType::kInt8, PrimitiveVariableType::kUint8, PrimitiveVariableType::kInt16,
@@ -39,8 +40,10 @@ void SetUpUnaryOperations() {
         unary_operations[static_cast<uint8_t>(UnaryPrefixOperator::kPlus)][{ val_type, const_type }] = const_type;
         unary_operations[static_cast<uint8_t>(UnaryPrefixOperator::kMinus)][{ val_type, const_type }] = const_type;
 
-        if (primitive_type != PrimitiveVariableType::kF32 && primitive_type != PrimitiveVariableType::kF64)
+        if (IsTypeInteger(primitive_type)) {
           unary_operations[static_cast<uint8_t>(UnaryPrefixOperator::kTilda)][{ val_type, const_type }] = const_type;
+          bit_operations[{ val_type, const_type }] = const_type;
+        }
       }
 
       std::shared_ptr<TIDVariableType> ref_type = SetParamsToType(type, false, true);
@@ -68,7 +71,7 @@ void SetUpUnaryOperations() {
 
 constexpr BinaryOperator arithmetic_ops[] = {
   BinaryOperator::kMultiplication, BinaryOperator::kDivision, BinaryOperator::kModulus,
-  BinaryOperator::kAddition, BinaryOperator::kSubtraction,
+  BinaryOperator::kAddition, BinaryOperator::kSubtraction, BinaryOperator::kExponentiation
 };
 constexpr BinaryOperator bitwise_ops[] = {
   BinaryOperator::kBitwiseShiftLeft, BinaryOperator::kBitwiseShiftRight, BinaryOperator::kBitwiseAnd,
@@ -76,7 +79,8 @@ constexpr BinaryOperator bitwise_ops[] = {
 };
 constexpr BinaryOperator assignment_arithmetic_ops[] = {
   BinaryOperator::kAssignment, BinaryOperator::kAdditionAssignment, BinaryOperator::kSubtractionAssignment,
-  BinaryOperator::kMultiplicationAssignment, BinaryOperator::kDivisionAssignment, BinaryOperator::kModulusAssignment
+  BinaryOperator::kMultiplicationAssignment, BinaryOperator::kDivisionAssignment, BinaryOperator::kModulusAssignment,
+  BinaryOperator::kExponentiationAssignment
 };
 constexpr BinaryOperator assignment_bitwise_ops[] = {
   BinaryOperator::kBitwiseShiftLeftAssignment, BinaryOperator::kBitwiseShiftRightAssignment,
@@ -114,7 +118,7 @@ void SetUpBinaryOperations() {
         for (BinaryOperator op : bitwise_ops) {
           for (auto lhs_val_type : value_types)
             for (auto rhs_val_type : value_types)
-              binary_operations[op][{ { lhs_val_type, const_type }, { rhs_val_type, const_type } }] = const_bool_type;
+              binary_operations[op][{ { lhs_val_type, const_type }, { rhs_val_type, const_type } }] = type;
         }
       }
 
@@ -142,6 +146,11 @@ void SetUpBinaryOperations() {
         for (auto rhs_val_type : value_types)
           binary_operations[op][{ { lhs_val_type, const_bool_type }, { rhs_val_type, const_bool_type } }] = const_bool_type;
     }
+    for (BinaryOperator op : { BinaryOperator::kBitwiseAnd, BinaryOperator::kBitwiseOr, BinaryOperator::kBitwiseXor }) {
+      for (auto lhs_val_type : value_types)
+        for (auto rhs_val_type : value_types)
+          binary_operations[op][{ { lhs_val_type, const_bool_type }, { rhs_val_type, const_bool_type } }] = const_bool_type;
+    }
     std::shared_ptr<TIDVariableType> ref_bool_type = SetParamsToType(bool_type, false, true);
     for (BinaryOperator op : assignment_bitwise_ops) {
       for (auto rhs_val_type : value_types) {
@@ -167,6 +176,16 @@ std::shared_ptr<TIDValue> UnaryOperation(uint8_t op, const std::shared_ptr<TIDVa
   throw UnknownOperator(lexeme, UnaryPrefixOperator::kUnknown, nullptr);
 }
 
+std::shared_ptr<TIDVariableType> BitOperationType(const std::shared_ptr<TIDValue> & value) {
+  if (!set_up_unary) SetUpUnaryOperations();
+  for (auto d_type : GetDerivedTypes(value)) {
+    VariableTypeWithValue type_with_value = { d_type->GetValueType(), d_type->GetType() };
+    if (bit_operations.count(type_with_value))
+      return bit_operations[type_with_value];
+  }
+  return nullptr;
+}
+
 std::shared_ptr<TIDValue> UnaryPrefixOperation(UnaryPrefixOperator op, const std::shared_ptr<TIDValue> & val,
       const Lexeme & lexeme) {
   auto type = val->GetType();
@@ -225,7 +244,7 @@ std::shared_ptr<TIDValue> BinaryOperationRPN(const std::shared_ptr<TIDValue> & l
         if (lhs_type->GetType() == VariableType::kComplex) {
           // complex is always an address
           // FROM TO SIZE OP::COPY; from = rhs; to = lhs; size = sizeof(struct)
-          rpn.PushNode(RPNOperand(lhs_type->GetSize()));
+          rpn.PushNode(RPNOperand(lhs_type_clean->GetSize()));
           rpn.PushNode(RPNOperator(RPNOperatorType::kCopyTF));
         } else {
           Cast(rhs, SetParamsToType(rhs_type, true, false), rpn);
@@ -331,6 +350,9 @@ std::shared_ptr<TIDValue> BinaryOperationRPN(const std::shared_ptr<TIDValue> & l
             case BinaryOperator::kModulusAssignment:
               rpn.PushNode(RPNOperator(RPNOperatorType::kModulus, lhs_prim));
               break;
+            case BinaryOperator::kExponentiationAssignment:
+              rpn.PushNode(RPNOperator(RPNOperatorType::kPower, lhs_prim));
+              break;
             case BinaryOperator::kBitwiseShiftLeftAssignment:
               rpn.PushNode(RPNOperator(RPNOperatorType::kBitwiseShiftLeft, lhs_prim));
               break;
@@ -392,6 +414,9 @@ std::shared_ptr<TIDValue> BinaryOperationRPN(const std::shared_ptr<TIDValue> & l
             case BinaryOperator::kModulus:
               rpn.PushNode(RPNOperator(RPNOperatorType::kModulus, lhs_prim));
               break;
+            case BinaryOperator::kExponentiation:
+              rpn.PushNode(RPNOperator(RPNOperatorType::kPower, lhs_prim));
+              break;
             case BinaryOperator::kBitwiseShiftLeft:
               rpn.PushNode(RPNOperator(RPNOperatorType::kBitwiseShiftLeft, lhs_prim));
               break;
@@ -426,18 +451,9 @@ std::shared_ptr<TIDValue> BinaryOperationRPN(const std::shared_ptr<TIDValue> & l
               rpn.PushNode(RPNOperator(RPNOperatorType::kMoreOrEqual, lhs_prim));
               break;
             case BinaryOperator::kLogicalAnd:
-              rpn.PushNode(RPNOperator(RPNOperatorType::kSave));
-              rpn.PushNode(RPNOperator(RPNOperatorType::kToBool, lhs_prim));
-              rpn.PushNode(RPNOperator(RPNOperatorType::kRestore));
-              rpn.PushNode(RPNOperator(RPNOperatorType::kToBool, lhs_prim));
-              rpn.PushNode(RPNOperator(RPNOperatorType::kBitwiseAnd, PrimitiveVariableType::kBool));
-              break;
             case BinaryOperator::kLogicalOr:
-              rpn.PushNode(RPNOperator(RPNOperatorType::kSave));
-              rpn.PushNode(RPNOperator(RPNOperatorType::kToBool, lhs_prim));
-              rpn.PushNode(RPNOperator(RPNOperatorType::kRestore));
-              rpn.PushNode(RPNOperator(RPNOperatorType::kToBool, lhs_prim));
-              rpn.PushNode(RPNOperator(RPNOperatorType::kBitwiseOr, PrimitiveVariableType::kBool));
+              // short-circuited with jumps by syntax analyzer, never evaluated eagerly
+              assert(false);
               break;
             default: break;
           }
@@ -18,3 +18,6 @@ std::shared_ptr<TIDValue> UnaryPostfixOperationRPN(const std::shared_ptr<TIDValu
     UnaryPostfixOperator op, const Lexeme & lexeme, RPN & rpn);
 std::shared_ptr<TIDValue> BinaryOperationRPN(const std::shared_ptr<TIDValue> & lhs, BinaryOperator op,
     const std::shared_ptr<TIDValue> & rhs, const Lexeme & lexeme, RPN & rpn);
+
+// Integer type that bit intrinsics (popcount, clz, ctz, rotl, rotr, bswap) work on for value; nullptr if none
+std::shared_ptr<TIDVariableType> BitOperationType(const std::shared_ptr<TIDValue> & value);
@@ -6,10 +6,10 @@
 #include <queue>
 
 
-std::wstring operator_string[kOperatorCount];
-std::map<std::wstring, UnaryPrefixOperator> unary_prefix_operator_by_string;
-std::map<std::wstring, UnaryPostfixOperator> unary_postfix_operator_by_string;
-std::map<std::wstring, BinaryOperator> binary_operator_by_string;
+std::string operator_string[kOperatorCount];
+std::map<std::string, UnaryPrefixOperator> unary_prefix_operator_by_string;
+std::map<std::string, UnaryPostfixOperator> unary_postfix_operator_by_string;
+std::map<std::string, BinaryOperator> binary_operator_by_string;
 
 UnaryPrefixOperator Operator::GetUnaryPrefixOperator() const {
   if (type_ != OperatorType::kUnaryPrefix)
@@ -30,8 +30,8 @@ BinaryOperator Operator::GetBinaryOperator() const {
 
 bool set_up = false;
 void SetUpOperatorString() {
-#define Set(op, value) operator_string[static_cast<uint8_t>(current_operator::op)] = L"" value;\
-  current_map[L"" value] = current_operator::op
+#define Set(op, value) operator_string[static_cast<uint8_t>(current_operator::op)] = "" value;\
+  current_map["" value] = current_operator::op
 
 #define current_operator UnaryPrefixOperator
 #define current_map unary_prefix_operator_by_string
@@ -93,6 +93,8 @@ void SetUpOperatorString() {
   Set(kBitwiseAndAssignment, "&=");
   Set(kBitwiseOrAssignment, "|=");
   Set(kBitwiseXorAssignment, "^=");
+  Set(kExponentiation, "**");
+  Set(kExponentiationAssignment, "**=");
 #undef current_operator
 #undef current_map
 
@@ -101,7 +103,7 @@ void SetUpOperatorString() {
   set_up = true;
 }
 
-std::wstring Operator::ToString() const {
+std::string Operator::ToString() const {
   switch (type_) {
     case OperatorType::kUnaryPrefix:
       return ::ToString(u_pre_op_);
@@ -112,37 +114,37 @@ std::wstring Operator::ToString() const {
   }
 }
 
-std::wstring ToString(UnaryPrefixOperator op) {
+std::string ToString(UnaryPrefixOperator op) {
   if (!set_up) SetUpOperatorString();
-  if (op == UnaryPrefixOperator::kUnknown) return L"";
+  if (op == UnaryPrefixOperator::kUnknown) return "";
   return operator_string[static_cast<uint8_t>(op)];
 }
-std::wstring ToString(UnaryPostfixOperator op) {
+std::string ToString(UnaryPostfixOperator op) {
   if (!set_up) SetUpOperatorString();
-  if (op == UnaryPostfixOperator::kUnknown) return L"";
+  if (op == UnaryPostfixOperator::kUnknown) return "";
   return operator_string[static_cast<uint8_t>(op)];
 }
-std::wstring ToString(BinaryOperator op) {
+std::string ToString(BinaryOperator op) {
   if (!set_up) SetUpOperatorString();
-  if (op == BinaryOperator::kUnknown) return L"";
+  if (op == BinaryOperator::kUnknown) return "";
   return operator_string[static_cast<uint8_t>(op)];
 }
 
-UnaryPrefixOperator UnaryPrefixOperatorByString(const std::wstring & str) {
+UnaryPrefixOperator UnaryPrefixOperatorByString(const std::string & str) {
   if (!set_up) SetUpOperatorString();
   if (unary_prefix_operator_by_string.count(str))
     return unary_prefix_operator_by_string[str];
   else
     return UnaryPrefixOperator::kUnknown;
 }
-UnaryPostfixOperator UnaryPostfixOperatorByString(const std::wstring & str) {
+UnaryPostfixOperator UnaryPostfixOperatorByString(const std::string & str) {
   if (!set_up) SetUpOperatorString();
   if (unary_postfix_operator_by_string.count(str))
     return unary_postfix_operator_by_string[str];
   else
     return UnaryPostfixOperator::kUnknown;
 }
-BinaryOperator BinaryOperatorByString(const std::wstring & str) {
+BinaryOperator BinaryOperatorByString(const std::string & str) {
   if (!set_up) SetUpOperatorString();
   if (binary_operator_by_string.count(str))
     return binary_operator_by_string[str];
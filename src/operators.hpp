@@ -4,10 +4,10 @@
 #include <string>
 #include "TID.hpp"
 
-constexpr uint8_t kOperatorCount = 44;
+constexpr uint8_t kOperatorCount = 46;
 constexpr uint8_t kUnaryPrefixOperatorCount = 10; // yeah I deleted some, so what? :)
 constexpr uint8_t kUnaryPostfixOperatorCount = 2;
-constexpr uint8_t kBinaryOperatorCount = 32;
+constexpr uint8_t kBinaryOperatorCount = 34;
 
 enum class OperatorType : uint8_t {
   kUnaryPrefix, kUnaryPostfix, kBinary
@@ -65,6 +65,8 @@ enum class BinaryOperator : uint8_t {
   kBitwiseAndAssignment         = 41,
   kBitwiseOrAssignment          = 42,
   kBitwiseXorAssignment         = 43,
+  kExponentiation               = 44,
+  kExponentiationAssignment     = 45,
   kUnknown                      = 255
 };
 
@@ -79,7 +81,7 @@ class Operator {
   UnaryPostfixOperator GetUnaryPostfixOperator() const;
   BinaryOperator GetBinaryOperator() const;
 
-  std::wstring ToString() const;
+  std::string ToString() const;
 
  private:
   OperatorType type_;
@@ -90,10 +92,10 @@ class Operator {
   };
 };
 
-std::wstring ToString(UnaryPrefixOperator op);
-std::wstring ToString(UnaryPostfixOperator op);
-std::wstring ToString(BinaryOperator op);
+std::string ToString(UnaryPrefixOperator op);
+std::string ToString(UnaryPostfixOperator op);
+std::string ToString(BinaryOperator op);
 
-UnaryPrefixOperator UnaryPrefixOperatorByString(const std::wstring & str);
-UnaryPostfixOperator UnaryPostfixOperatorByString(const std::wstring & str);
-BinaryOperator BinaryOperatorByString(const std::wstring & str);
+UnaryPrefixOperator UnaryPrefixOperatorByString(const std::string & str);
+UnaryPostfixOperator UnaryPostfixOperatorByString(const std::string & str);
+BinaryOperator BinaryOperatorByString(const std::string & str);
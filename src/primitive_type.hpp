@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+// if you change this list you need to change another few
+// parameters in operators.cpp in casting section
+constexpr uint8_t kPrimitiveVariableTypeCount = 13;
+enum class PrimitiveVariableType : uint8_t {
+  kInt8 = 0, kInt16 = 1, kInt32 = 2, kInt64 = 3,
+  kUint8 = 4, kUint16 = 5, kUint32 = 6, kUint64 = 7,
+  kF32 = 8, kF64 = 9, kBool = 10, kChar = 11, kUnknown = 12
+};
@@ -2,79 +2,133 @@
 #include "TID.hpp"
 #include "exceptions.hpp"
 #include "generation.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cctype>
+#include <cmath>
+#include <cstring>
 #include <map>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <iostream>
+#include <cerrno>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #undef assert
 
-void Assert(bool x, std::wstring x_expr, uint64_t pc) {
+void Assert(bool x, std::string x_expr, uint64_t pc) {
   if (!x) {
-    std::wcout << "Assertion failed: " << x_expr << std::endl;
+    std::wcout << "Assertion failed: " << x_expr.c_str() << std::endl;
     std::wcout << "pc = " << pc << std::endl;
 
     exit(1);
   }
 }
-#define assert(x) Assert(x, L"" #x, run::pc)
+#define assert(x) Assert(x, "" #x, run::pc)
 
 namespace run {
-  constexpr uint32_t
-  STACK_SIZE = 1 * 1024 * 1024;
-  constexpr uint32_t
-  MAX_SIZE = 10 * 1024 * 1024;
   constexpr uint64_t NULLPTR = 0;
 
-// if index < STACK_SIZE -> it is on stack
-// else, heap
-  uint8_t memory[MAX_SIZE];
-  uint8_t allocated[MAX_SIZE / 8];
+// Files mapped by mmap() are placed after heap, in [MAX_SIZE; MAX_SIZE + MAPPED_SIZE)
+  constexpr uint64_t MAPPED_SIZE = 1ull << 36;
+  uint64_t mapped_capacity = MAPPED_SIZE;
 
-  bool IsByteAllocated(uint64_t index) {
-    return index < MAX_SIZE && ((allocated[index / 8] >> (index % 8)) & 1);
+// Address space for all the memory is reserved at once, only [0; MAX_SIZE) is backed from the start
+  uint8_t * ReserveMemory() {
+    void * ptr = mmap(nullptr, MAX_SIZE + MAPPED_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (ptr == MAP_FAILED) {
+      mapped_capacity = 0;
+      ptr = mmap(nullptr, MAX_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    }
+    if (ptr == MAP_FAILED || mprotect(ptr, MAX_SIZE, PROT_READ | PROT_WRITE) != 0)
+      throw std::bad_alloc();
+    return static_cast<uint8_t *>(ptr);
   }
 
-  void AllocateByte(uint64_t index) {
-    if (index >= MAX_SIZE)
-      throw MemoryOutOfBoundsError();
-    allocated[index / 8] |= 1 << (index % 8);
-    memory[index] = 0;
-  }
+// if index < STACK_SIZE -> it is on stack
+// else if index < MAX_SIZE, heap
+// else, mapped file
+  uint8_t * memory = ReserveMemory();
+  uint8_t allocated[MAX_SIZE / 8];
 
-  void DeallocateByte(uint64_t index) {
-    if (index >= MAX_SIZE)
+// address of char[] of mapped file -> end of its data; read-only
+  std::map<uint64_t, uint64_t> mapped_files;
+  uint64_t mp = MAX_SIZE; // mapped files pointer
+
+// address of char[] overwritten by read() -> length it was allocated with, as its length may get shorter
+  std::map<uint64_t, uint64_t> read_buffers;
+
+// Checks that bits of bytes [from; to) in allocated are all equal to value
+  bool IsChunkMarked(uint64_t from, uint64_t to, bool value) {
+    if (to < from || to > MAX_SIZE) return false;
+    if (from == to) return true;
+    uint8_t full = value ? 255 : 0;
+    uint64_t first = from / 8, last = (to - 1) / 8;
+    uint8_t head = static_cast<uint8_t>(255 << (from % 8));
+    uint8_t tail = static_cast<uint8_t>(255 >> (7 - (to - 1) % 8));
+    if (first == last)
+      return (allocated[first] & head & tail) == (full & head & tail);
+    if ((allocated[first] & head) != (full & head) || (allocated[last] & tail) != (full & tail))
+      return false;
+    return std::all_of(allocated + first + 1, allocated + last, [full](uint8_t x) { return x == full; });
+  }
+
+// Sets bits of bytes [from; to) in allocated to value
+  void MarkChunk(uint64_t from, uint64_t to, bool value) {
+    if (to < from || to > MAX_SIZE)
       throw MemoryOutOfBoundsError();
-    allocated[index / 8] &= (1 << (index % 8)) ^ 255;
+    if (from == to) return;
+    uint64_t first = from / 8, last = (to - 1) / 8;
+    uint8_t head = static_cast<uint8_t>(255 << (from % 8));
+    uint8_t tail = static_cast<uint8_t>(255 >> (7 - (to - 1) % 8));
+    if (first == last) head &= tail;
+    if (value) allocated[first] |= head;
+    else allocated[first] &= static_cast<uint8_t>(~head);
+    if (first == last) return;
+    if (value) allocated[last] |= tail;
+    else allocated[last] &= static_cast<uint8_t>(~tail);
+    memset(allocated + first + 1, value ? 255 : 0, last - first - 1);
+  }
+
+// returns true if [from; to) lies inside one mapped file
+  bool IsChunkMapped(uint64_t from, uint64_t to) {
+    if (to < from || from < MAX_SIZE) return false;
+    auto it = mapped_files.upper_bound(from);
+    if (it == mapped_files.begin()) return false;
+    --it;
+    return to <= it->second;
   }
 
 // [from; to)
 // returns true if all bytes are allocated
 // false if not
   bool IsChunkAllocated(uint64_t from, uint64_t to) {
-    bool ok = true;
-    for (uint64_t i = from; i < to; ++i)
-      ok &= IsByteAllocated(i);
-    return ok;
+    return IsChunkMarked(from, to, true) || IsChunkMapped(from, to);
+  }
+
+// same as IsChunkAllocated, but mapped files are read-only
+  bool IsChunkWritable(uint64_t from, uint64_t to) {
+    return IsChunkMarked(from, to, true);
   }
 
 // returns true if none of the bytes are allocated
 // false if some do
   bool IsChunkNotAllocated(uint64_t from, uint64_t to) {
-    bool ok = true;
-    for (uint64_t i = from; i < to; ++i)
-      ok &= !IsByteAllocated(i);
-    return ok;
+    return IsChunkMarked(std::min<uint64_t>(from, MAX_SIZE), std::min<uint64_t>(to, MAX_SIZE), false);
   }
 
   void AllocateChunk(uint64_t from, uint64_t to) {
-    for (uint64_t i = from; i < to; ++i)
-      AllocateByte(i);
+    MarkChunk(from, to, true);
+    memset(memory + from, 0, to - from);
   }
 
   void DeallocateChunk(uint64_t from, uint64_t to) {
-    for (uint64_t i = from; i < to; ++i)
-      DeallocateByte(i);
+    MarkChunk(from, to, false);
   }
 
   std::map<uint64_t, std::vector<uint64_t>> func_sps;
@@ -97,6 +151,7 @@ namespace run {
   uint64_t pc = 0; // program counter
   uint64_t program_size;
 
+
   void Push(uint64_t data) { stack.push_back(data); }
 
   uint64_t Pop() {
@@ -118,26 +173,55 @@ namespace run {
     return ptr;
   }
 
+  void UnmapFile(uint64_t address) {
+    auto page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    uint64_t begin = address + 4 - page;
+    uint64_t end = (mapped_files[address] + page - 1) / page * page;
+    mmap(memory + begin, end - begin, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+    mapped_files.erase(address);
+  }
+
   void DeleteMemory(uint64_t address, uint64_t size) {
+    if (mapped_files.count(address)) {
+      UnmapFile(address);
+      return;
+    }
     assert(IsChunkAllocated(address, address + size));
     if (address < STACK_SIZE) assert(false); // trying to delete memory on stack
+    if (auto it = read_buffers.find(address); it != read_buffers.end()) {
+      size = std::max(size, it->second + 4);
+      read_buffers.erase(it);
+    }
     DeallocateChunk(address, address + size);
   }
 
+  void Reset() {
+    while (!mapped_files.empty())
+      UnmapFile(mapped_files.begin()->first);
+    mp = MAX_SIZE;
+    read_buffers.clear();
+    std::fill(std::begin(allocated), std::end(allocated), 0);
+    func_sps.clear();
+    stack.clear();
+    sp_stack.clear();
+    sp = 1;
+    hp = STACK_SIZE;
+    pc = 0;
+    AllocateChunk(0, STACK_SIZE);
+  }
+
   void WriteMemory(uint64_t data, uint64_t address, uint8_t size = 8) {
-    for (uint32_t i = 0; i < size; ++i) {
-      if (!IsByteAllocated(address + i)) throw MemoryNotAllocated();
+    if (!IsChunkWritable(address, address + size)) throw MemoryNotAllocated();
+    for (uint32_t i = 0; i < size; ++i)
       memory[address + i] = data >> (i * 8) & 255;
-    }
   }
 
   uint64_t ReadMemory(uint64_t address, uint8_t size = 8) {
+    if (!IsChunkAllocated(address, address + size))
+      throw MemoryNotAllocated();
     uint64_t result = 0;
-    for (uint64_t i = 0; i < size; ++i) {
-      if (!IsByteAllocated(address + i))
-        throw MemoryNotAllocated();
+    for (uint64_t i = 0; i < size; ++i)
       result |= static_cast<uint64_t>(memory[address + i]) << (i * 8);
-    }
     return result;
   }
   void Load(uint8_t size) {
@@ -167,8 +251,9 @@ namespace run {
   }
 
   void Call() {
-    Jmp();
-    func_sps[pc].push_back(sp_stack.back().address);
+    auto address = Pop();
+    Jump(address);
+    func_sps[address].push_back(sp_stack.back().address);
   }
 
   void Jz() {
@@ -176,6 +261,17 @@ namespace run {
     if (cond == 0) Jump(address);
   }
 
+  void Jnz() {
+    auto [cond, address] = PopBin();
+    if (cond != 0) Jump(address);
+  }
+
+  void JumpTable() {
+    auto [count, table] = PopBin();
+    uint64_t index = Pop();
+    Jump(table + 2 * std::min(index, count));
+  }
+
   void PushStack() {
     auto [size, function_pc] = PopBin();
     sp_stack.emplace_back(sp, function_pc, size);
@@ -207,29 +303,530 @@ namespace run {
     DeleteMemory(address, size);
   }
 
+  // Output of write() is collected here and sent to stdout in big chunks
+  constexpr size_t OUTPUT_BUFFER_SIZE = 64 * 1024;
+  bool unbuffered_output = false;
+  std::string output_buffer;
+
+  // returns false on error
+  bool WriteAll(int fd, iovec * iov, int count) {
+    while (count > 0) {
+      ssize_t written = writev(fd, iov, count);
+      if (written < 0) {
+        if (errno == EINTR) continue;
+        return false;
+      }
+      auto left = static_cast<size_t>(written);
+      while (count > 0 && left >= iov->iov_len) {
+        left -= iov->iov_len;
+        ++iov;
+        --count;
+      }
+      if (count > 0) {
+        iov->iov_base = static_cast<char *>(iov->iov_base) + left;
+        iov->iov_len -= left;
+      }
+    }
+    return true;
+  }
+
+  // Writes buffered output followed by [data; data + size)
+  void FlushOutput(const uint8_t * data = nullptr, size_t size = 0) {
+    if (output_buffer.empty() && size == 0) return;
+    std::wcout.flush(); // anything printed by translator itself goes first
+    iovec iov[2] = {
+      { output_buffer.data(), output_buffer.size() },
+      { const_cast<uint8_t *>(data), size }
+    };
+    if (!WriteAll(STDOUT_FILENO, iov, 2))
+      throw OutputError();
+    output_buffer.clear();
+  }
+
+  void Output(const uint8_t * data, size_t size) {
+    if (unbuffered_output || output_buffer.size() + size >= OUTPUT_BUFFER_SIZE)
+      FlushOutput(data, size);
+    else
+      output_buffer.append(reinterpret_cast<const char *>(data), size);
+  }
+
+  // Input for read() is taken from stdin in big chunks
+  constexpr size_t INPUT_BUFFER_SIZE = 64 * 1024;
+  bool reuse_read_buffers = false;
+  uint8_t input_buffer[INPUT_BUFFER_SIZE];
+  size_t input_begin = 0, input_end = 0;
+  bool input_eof = false;
+  std::string long_line; // line that did not fit into the rest of input_buffer
+
+  // returns false if there is nothing more to read
+  bool FillInput() {
+    if (input_eof) return false;
+    ssize_t count;
+    do {
+      count = read(STDIN_FILENO, input_buffer, INPUT_BUFFER_SIZE);
+    } while (count < 0 && errno == EINTR);
+    input_begin = 0;
+    input_end = count > 0 ? static_cast<size_t>(count) : 0;
+    input_eof = count <= 0;
+    return !input_eof;
+  }
+
+  // Next line without '\n' (empty at the end of input)
+  std::pair<const uint8_t *, size_t> ReadLine() {
+    long_line.clear();
+    while (input_begin < input_end || FillInput()) {
+      const uint8_t * begin = input_buffer + input_begin;
+      size_t available = input_end - input_begin;
+      auto newline = static_cast<const uint8_t *>(memchr(begin, '\n', available));
+      if (!newline) {
+        long_line.append(reinterpret_cast<const char *>(begin), available);
+        input_begin = input_end;
+        continue;
+      }
+      auto length = static_cast<size_t>(newline - begin);
+      input_begin += length + 1;
+      if (long_line.empty()) return { begin, length };
+      long_line.append(reinterpret_cast<const char *>(begin), length);
+      break;
+    }
+    return { reinterpret_cast<const uint8_t *>(long_line.data()), long_line.size() };
+  }
+
   void Read() {
     auto var_address = Pop(); // address of char[] variable
-    std::wstring line;
-    std::getline(std::wcin, line);
-    if (line.back() == L'\n') line.pop_back();
-
-    auto new_address = NewMemory(line.size() + 4);
-    WriteMemory(line.size(), new_address, 4);
-    for (size_t i = 0; i < line.size(); ++i)
-      memory[new_address + 4 + i] = static_cast<unsigned char>(line[i]);
-    WriteMemory(new_address, var_address, 8);
+    FlushOutput();
+    auto [line, size] = ReadLine();
+
+    // array currently stored in variable is overwritten if allowed and was allocated long enough
+    auto address = ReadMemory(var_address, 8);
+    bool reuse = false;
+    if (reuse_read_buffers && address != NULLPTR && IsChunkWritable(address, address + 4)) {
+      uint64_t capacity = read_buffers.emplace(address, ReadMemory(address, 4)).first->second;
+      reuse = capacity >= size;
+    }
+    if (!reuse) {
+      address = NewMemory(size + 4);
+      WriteMemory(address, var_address, 8);
+      if (reuse_read_buffers) read_buffers[address] = size;
+    }
+    WriteMemory(size, address, 4);
+    if (!IsChunkWritable(address + 4, address + 4 + size))
+      throw MemoryNotAllocated();
+    memcpy(memory + address + 4, line, size);
   }
 
   void Write() {
     auto address = Pop(); // address of start of char[]
     auto size = ReadMemory(address, 4);
-    std::wstring line;
-    line.resize(size);
-    for (size_t i = 0; i < line.size(); ++i)
-      line[i] = memory[address + 4 + i];
-    std::wcout << line;
+    if (!IsChunkAllocated(address + 4, address + 4 + size))
+      throw MemoryNotAllocated();
+    Output(memory + address + 4, size);
+  }
+  // Contents and size of char[] at address
+  std::pair<const uint8_t *, uint64_t> StringAt(uint64_t address) {
+    if (address == NULLPTR) throw NullptrAccessedException();
+    auto size = ReadMemory(address, 4);
+    if (!IsChunkAllocated(address + 4, address + 4 + size))
+      throw MemoryNotAllocated();
+    return { memory + address + 4, size };
+  }
+
+  std::string ReadPath(uint64_t address) {
+    auto [data, size] = StringAt(address);
+    return std::string(reinterpret_cast<const char *>(data), size);
+  }
+
+  // Allocates char[] of given size on heap; returns its address
+  uint64_t NewString(uint64_t size) {
+    auto address = NewMemory(size + 4);
+    WriteMemory(size, address, 4);
+    return address;
+  }
+
+  void Compare() {
+    auto [lhs, rhs] = PopBin();
+    auto [lhs_data, lhs_size] = StringAt(lhs);
+    auto [rhs_data, rhs_size] = StringAt(rhs);
+    int result = memcmp(lhs_data, rhs_data, std::min(lhs_size, rhs_size));
+    if (result == 0) result = (lhs_size > rhs_size) - (lhs_size < rhs_size);
+    else result = result < 0 ? -1 : 1;
+    Push(static_cast<uint32_t>(result));
+  }
+
+  void Concat() {
+    auto [lhs, rhs] = PopBin();
+    auto [lhs_data, lhs_size] = StringAt(lhs);
+    auto [rhs_data, rhs_size] = StringAt(rhs);
+    auto address = NewString(lhs_size + rhs_size);
+    memcpy(memory + address + 4, lhs_data, lhs_size);
+    memcpy(memory + address + 4 + lhs_size, rhs_data, rhs_size);
+    Push(address);
+  }
+
+  void Find() {
+    auto from = Pop();
+    auto [address, pattern_address] = PopBin();
+    auto [data, size] = StringAt(address);
+    auto [pattern, pattern_size] = StringAt(pattern_address);
+    uint64_t result = -1ull;
+    if (pattern_size == 0) {
+      if (from <= size) result = from;
+    } else if (from < size) {
+      // memchr finds candidates for the first char, the rest is compared with memcmp
+      const uint8_t * end = data + size - pattern_size + 1;
+      for (const uint8_t * it = data + from; it < end; ++it) {
+        it = static_cast<const uint8_t *>(memchr(it, pattern[0], end - it));
+        if (!it) break;
+        if (memcmp(it + 1, pattern + 1, pattern_size - 1) == 0) {
+          result = it - data;
+          break;
+        }
+      }
+    }
+    Push(result);
+  }
+
+  void Substring() {
+    auto to = Pop();
+    auto [address, from] = PopBin();
+    auto [data, size] = StringAt(address);
+    to = std::min(to, size);
+    from = std::min(from, to);
+    auto result = NewString(to - from);
+    memcpy(memory + result + 4, data + from, to - from);
+    Push(result);
+  }
+
+  // Hashes 8 bytes at a time; the same contents give the same hash on every run
+  uint64_t HashBytes(const uint8_t * data, uint64_t size) {
+    constexpr uint64_t kMultiplier = 0x9E3779B97F4A7C15ull;
+    uint64_t hash = size * kMultiplier;
+    uint64_t word;
+    for (; size >= 8; data += 8, size -= 8) {
+      memcpy(&word, data, 8);
+      hash = (hash ^ word) * kMultiplier;
+      hash ^= hash >> 29;
+    }
+    word = 0;
+    memcpy(&word, data, size);
+    hash = (hash ^ word) * kMultiplier;
+    return hash ^ hash >> 32;
+  }
+
+  void Hash() {
+    auto [data, size] = StringAt(Pop());
+    Push(HashBytes(data, size));
+  }
+
+  // Calls f with null pointer to C++ type that holds elements of given type
+  template <typename F>
+  void DispatchElement(PrimitiveVariableType type, F f) {
+    switch (type) {
+      case PrimitiveVariableType::kInt8:
+        f(static_cast<int8_t *>(nullptr));
+        break;
+      case PrimitiveVariableType::kInt16:
+        f(static_cast<int16_t *>(nullptr));
+        break;
+      case PrimitiveVariableType::kInt32:
+        f(static_cast<int32_t *>(nullptr));
+        break;
+      case PrimitiveVariableType::kInt64:
+        f(static_cast<int64_t *>(nullptr));
+        break;
+      case PrimitiveVariableType::kUint8:
+      case PrimitiveVariableType::kChar:
+      case PrimitiveVariableType::kBool:
+        f(static_cast<uint8_t *>(nullptr));
+        break;
+      case PrimitiveVariableType::kUint16:
+        f(static_cast<uint16_t *>(nullptr));
+        break;
+      case PrimitiveVariableType::kUint32:
+        f(static_cast<uint32_t *>(nullptr));
+        break;
+      case PrimitiveVariableType::kUint64:
+        f(static_cast<uint64_t *>(nullptr));
+        break;
+      case PrimitiveVariableType::kF32:
+        f(static_cast<float *>(nullptr));
+        break;
+      case PrimitiveVariableType::kF64:
+        f(static_cast<double *>(nullptr));
+        break;
+      default: assert(false);
+    }
+  }
+
+  template <typename T>
+  T FromStack(uint64_t data) {
+    if constexpr (std::is_same_v<T, float>) {
+      auto bits = static_cast<uint32_t>(data);
+      float result;
+      memcpy(&result, &bits, sizeof(result));
+      return result;
+    } else if constexpr (std::is_same_v<T, double>) {
+      double result;
+      memcpy(&result, &data, sizeof(result));
+      return result;
+    } else
+      return static_cast<T>(data);
+  }
+
+  template <typename T>
+  uint64_t ToStack(T value) {
+    if constexpr (std::is_same_v<T, float>) {
+      uint32_t bits;
+      memcpy(&bits, &value, sizeof(bits));
+      return bits;
+    } else if constexpr (std::is_same_v<T, double>) {
+      uint64_t bits;
+      memcpy(&bits, &value, sizeof(bits));
+      return bits;
+    } else
+      return static_cast<std::make_unsigned_t<T>>(value);
+  }
+
+  // Array data is not aligned, so elements are accessed through memcpy
+  template <typename T>
+  T LoadElement(const uint8_t * data, uint64_t index) {
+    T result;
+    memcpy(&result, data + index * sizeof(T), sizeof(T));
+    return result;
+  }
+
+  // Strict weak ordering that puts NaNs last
+  template <typename T>
+  bool Less(T lhs, T rhs) {
+    if constexpr (std::is_floating_point_v<T>)
+      return lhs < rhs || (std::isnan(rhs) && !std::isnan(lhs));
+    else
+      return lhs < rhs;
+  }
+
+  struct ArrayRange {
+    uint8_t * data;  // first element of range
+    uint64_t from;   // index of it
+    uint64_t count;
+  };
+
+  // Elements [from; to) of array at address, range is clamped to its size
+  ArrayRange GetArrayRange(uint64_t address, uint64_t from, uint64_t to, uint64_t element_size, bool writable) {
+    if (address == NULLPTR) throw NullptrAccessedException();
+    to = std::min(to, ReadMemory(address, 4));
+    from = std::min(from, to);
+    uint64_t begin = address + 4 + from * element_size, end = address + 4 + to * element_size;
+    if (writable ? !IsChunkWritable(begin, end) : !IsChunkAllocated(begin, end))
+      throw MemoryNotAllocated();
+    return { memory + begin, from, to - from };
+  }
+
+  void Sort(PrimitiveVariableType type) {
+    auto to = Pop();
+    auto [address, from] = PopBin();
+    DispatchElement(type, [&](auto * tag) {
+      using T = std::remove_pointer_t<decltype(tag)>;
+      auto range = GetArrayRange(address, from, to, sizeof(T), true);
+      std::vector<T> elements(range.count);
+      memcpy(elements.data(), range.data, range.count * sizeof(T));
+      std::sort(elements.begin(), elements.end(), Less<T>);
+      memcpy(range.data, elements.data(), range.count * sizeof(T));
+    });
+  }
+
+  void ArrayFill(PrimitiveVariableType type) {
+    auto to = Pop();
+    auto from = Pop();
+    auto [address, value] = PopBin();
+    DispatchElement(type, [&](auto * tag) {
+      using T = std::remove_pointer_t<decltype(tag)>;
+      auto range = GetArrayRange(address, from, to, sizeof(T), true);
+      uint64_t size = range.count * sizeof(T);
+      if (size == 0) return;
+      // Filled part is doubled until the whole range is filled
+      T element = FromStack<T>(value);
+      memcpy(range.data, &element, sizeof(T));
+      for (uint64_t done = sizeof(T); done < size; done *= 2)
+        memcpy(range.data + done, range.data, std::min(done, size - done));
+    });
+  }
+
+  void ArrayCopy() {
+    auto element_size = Pop();
+    auto to = Pop();
+    auto [src, from] = PopBin();
+    auto [dst, at] = PopBin();
+    auto range = GetArrayRange(src, from, to, element_size, false);
+    if (dst == NULLPTR) throw NullptrAccessedException();
+    if (at + range.count > ReadMemory(dst, 4))
+      throw MemoryOutOfBoundsError();
+    uint64_t begin = dst + 4 + at * element_size, size = range.count * element_size;
+    if (!IsChunkWritable(begin, begin + size))
+      throw MemoryNotAllocated();
+    memmove(memory + begin, range.data, size);
+  }
+
+  void Sum(PrimitiveVariableType type) {
+    auto address = Pop();
+    DispatchElement(type, [&](auto * tag) {
+      using T = std::remove_pointer_t<decltype(tag)>;
+      auto range = GetArrayRange(address, 0, -1ull, sizeof(T), false);
+      if constexpr (std::is_floating_point_v<T>) {
+        double sum = 0;
+        for (uint64_t i = 0; i < range.count; ++i)
+          sum += LoadElement<T>(range.data, i);
+        Push(ToStack(sum));
+      } else {
+        // signed elements are sign-extended, so wrapping sum is the same as int64 one
+        uint64_t sum = 0;
+        for (uint64_t i = 0; i < range.count; ++i)
+          sum += static_cast<uint64_t>(LoadElement<T>(range.data, i));
+        Push(sum);
+      }
+    });
+  }
+
+  template <bool kMax>
+  void MinMax(PrimitiveVariableType type) {
+    auto address = Pop();
+    DispatchElement(type, [&](auto * tag) {
+      using T = std::remove_pointer_t<decltype(tag)>;
+      auto range = GetArrayRange(address, 0, -1ull, sizeof(T), false);
+      if (range.count == 0) throw EmptyArrayError();
+      T result = LoadElement<T>(range.data, 0);
+      for (uint64_t i = 1; i < range.count; ++i) {
+        T element = LoadElement<T>(range.data, i);
+        result = kMax ? std::max(result, element) : std::min(result, element);
+      }
+      Push(ToStack(result));
+    });
+  }
+
+  void LowerBound(PrimitiveVariableType type) {
+    auto to = Pop();
+    auto from = Pop();
+    auto [address, value] = PopBin();
+    DispatchElement(type, [&](auto * tag) {
+      using T = std::remove_pointer_t<decltype(tag)>;
+      auto range = GetArrayRange(address, from, to, sizeof(T), false);
+      T element = FromStack<T>(value);
+      uint64_t lo = 0, hi = range.count;
+      while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (Less(LoadElement<T>(range.data, mid), element))
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      Push(range.from + lo);
+    });
+  }
+
+  void Map() {
+    std::string path = ReadPath(Pop()); // address of start of char[] with path
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw FileMappingError();
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_size) > UINT32_MAX) {
+      close(fd);
+      throw FileMappingError();
+    }
+    auto size = static_cast<uint64_t>(info.st_size);
+    // Data starts at page boundary, its size goes to the end of the page before it
+    auto page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    uint64_t data = mp + page;
+    uint64_t end = data + (size + page - 1) / page * page;
+    bool ok = end <= MAX_SIZE + mapped_capacity && mprotect(memory + mp, page, PROT_READ | PROT_WRITE) == 0;
+    if (ok && size > 0)
+      ok = mmap(memory + data, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) != MAP_FAILED;
+    close(fd);
+    if (!ok) throw FileMappingError();
+
+    uint64_t address = data - 4;
+    for (uint32_t i = 0; i < 4; ++i)
+      memory[address + i] = size >> (i * 8) & 255;
+    mprotect(memory + mp, page, PROT_READ);
+    mapped_files[address] = data + size;
+    mp = end;
+    Push(address);
+  }
+
+  // Reads up to size bytes, returns number of bytes read
+  size_t ReadAll(int fd, uint8_t * to, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+      ssize_t count = read(fd, to + done, size - done);
+      if (count < 0 && errno == EINTR) continue;
+      if (count <= 0) break;
+      done += static_cast<size_t>(count);
+    }
+    return done;
+  }
+
+  // Allocates array for size bytes of elements and stores it to variable at var_address; returns its data
+  uint8_t * NewArray(uint64_t var_address, uint64_t element_size, uint64_t size) {
+    uint64_t count = size / element_size;
+    auto address = NewMemory(count * element_size + 4);
+    WriteMemory(count, address, 4);
+    WriteMemory(address, var_address, 8);
+    return memory + address + 4;
+  }
+
+  void ReadBinary() {
+    auto path_address = Pop();
+    auto [var_address, element_size] = PopBin();
+    if (path_address != NULLPTR) {
+      int fd = open(ReadPath(path_address).c_str(), O_RDONLY);
+      struct stat info;
+      if (fd < 0 || fstat(fd, &info) != 0) {
+        if (fd >= 0) close(fd);
+        throw FileAccessError();
+      }
+      auto size = static_cast<uint64_t>(info.st_size) / element_size * element_size;
+      uint8_t * data = NewArray(var_address, element_size, size);
+      bool ok = ReadAll(fd, data, size) == size;
+      close(fd);
+      if (!ok) throw FileAccessError();
+      return;
+    }
+    // stdin is read till the end, starting with what is left in input buffer
+    FlushOutput();
+    std::vector<uint8_t> data(input_buffer + input_begin, input_buffer + input_end);
+    input_begin = input_end;
+    size_t block = INPUT_BUFFER_SIZE;
+    while (!input_eof) {
+      size_t size = data.size();
+      data.resize(size + block);
+      size_t count = ReadAll(STDIN_FILENO, data.data() + size, block);
+      data.resize(size + count);
+      input_eof = count < block;
+      block *= 2;
+    }
+    auto size = data.size() / element_size * element_size;
+    memcpy(NewArray(var_address, element_size, size), data.data(), size);
+  }
+
+  void WriteBinary() {
+    auto path_address = Pop();
+    auto [address, element_size] = PopBin();
+    if (address == NULLPTR) throw NullptrAccessedException();
+    auto size = ReadMemory(address, 4) * element_size;
+    if (!IsChunkAllocated(address + 4, address + 4 + size))
+      throw MemoryNotAllocated();
+    uint8_t * data = memory + address + 4;
+    if (path_address == NULLPTR) {
+      Output(data, size);
+      return;
+    }
+    int fd = open(ReadPath(path_address).c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) throw FileAccessError();
+    iovec iov = { data, size };
+    bool ok = WriteAll(fd, &iov, 1);
+    close(fd);
+    if (!ok) throw FileAccessError();
   }
 
+
   void Return() {
     auto cur_sp = sp_stack.back().address;
     auto ret_ptr = ReadMemory(cur_sp, 8);
@@ -263,12 +860,12 @@ namespace run {
     Push(saved_element);
   }
 
+  // Ranges are checked once, chunks may overlap
   void Copy(uint64_t from, uint64_t to, uint64_t size) {
-    for (size_t i = 0; i < size; ++i) {
-      if (!IsByteAllocated(from + i) || !IsByteAllocated(to + i))
-        throw MemoryNotAllocated();
-      memory[to + i] = memory[from + i];
-    }
+    if (size == 0) return;
+    if (!IsChunkAllocated(from, from + size) || !IsChunkWritable(to, to + size))
+      throw MemoryNotAllocated();
+    memmove(memory + to, memory + from, size);
   }
 
   void CopyFT() {
@@ -285,11 +882,10 @@ namespace run {
 
   void Fill() {
     auto [from, size] = PopBin();
-    for (uint64_t i = 0; i < size; ++i) {
-      if (!IsByteAllocated(from + i))
-        throw MemoryNotAllocated();
-      memory[from + i] = 0;
-    }
+    if (size == 0) return;
+    if (!IsChunkWritable(from, from + size))
+      throw MemoryNotAllocated();
+    memset(memory + from, 0, size);
   }
 
   uint64_t PruneNum(uint64_t data, PrimitiveVariableType type) {
@@ -298,6 +894,106 @@ namespace run {
     return data & ((1ull << (size * 8)) - 1); // 1ull << 64 = 0; 0 - 1 = -1 = 2^64-1
   }
 
+  constexpr size_t FORMAT_BUFFER_SIZE = 32;
+
+  // Writes data of type as text to buf (FORMAT_BUFFER_SIZE bytes); returns its length.
+  // Floating point numbers are written in shortest form that reads back to the same value
+  size_t FormatNumber(uint64_t data, PrimitiveVariableType type, char * buf) {
+    data = PruneNum(data, type);
+    char * last = buf + FORMAT_BUFFER_SIZE;
+    char * end = buf;
+    switch (type) {
+      case PrimitiveVariableType::kInt8:
+        end = std::to_chars(buf, last, static_cast<int8_t>(data)).ptr;
+        break;
+      case PrimitiveVariableType::kInt16:
+        end = std::to_chars(buf, last, static_cast<int16_t>(data)).ptr;
+        break;
+      case PrimitiveVariableType::kInt32:
+        end = std::to_chars(buf, last, static_cast<int32_t>(data)).ptr;
+        break;
+      case PrimitiveVariableType::kInt64:
+        end = std::to_chars(buf, last, static_cast<int64_t>(data)).ptr;
+        break;
+      case PrimitiveVariableType::kUint8:
+      case PrimitiveVariableType::kUint16:
+      case PrimitiveVariableType::kUint32:
+      case PrimitiveVariableType::kUint64:
+        end = std::to_chars(buf, last, data).ptr;
+        break;
+      case PrimitiveVariableType::kF32: {
+        auto bits = static_cast<uint32_t>(data);
+        float data_f;
+        memcpy(&data_f, &bits, sizeof(data_f));
+        end = std::to_chars(buf, last, data_f).ptr;
+      }
+        break;
+      case PrimitiveVariableType::kF64: {
+        double data_d;
+        memcpy(&data_d, &data, sizeof(data_d));
+        end = std::to_chars(buf, last, data_d).ptr;
+      }
+        break;
+      case PrimitiveVariableType::kChar:
+        *end++ = static_cast<char>(data);
+        break;
+      case PrimitiveVariableType::kBool: {
+        const char * text = data ? "true" : "false";
+        end = std::copy(text, text + strlen(text), buf);
+      }
+        break;
+      default: assert(false);
+    }
+    return end - buf;
+  }
+
+  void WriteNumber(PrimitiveVariableType type) {
+    char buf[FORMAT_BUFFER_SIZE];
+    size_t size = FormatNumber(Pop(), type, buf);
+    Output(reinterpret_cast<const uint8_t *>(buf), size);
+  }
+
+  void Format(PrimitiveVariableType type) {
+    char buf[FORMAT_BUFFER_SIZE];
+    size_t size = FormatNumber(Pop(), type, buf);
+    auto address = NewString(size);
+    memcpy(memory + address + 4, buf, size);
+    Push(address);
+  }
+
+  // Parses number (int64 or f64) at the start of [from; to) of char[], skipping leading spaces and tabs;
+  // throws NumberParseError if there is none or it is out of range
+  void Parse(PrimitiveVariableType type) {
+    auto to = Pop();
+    auto [address, from] = PopBin();
+    if (address == NULLPTR) throw NullptrAccessedException();
+    to = std::min(to, ReadMemory(address, 4));
+    if (from >= to) throw NumberParseError();
+    if (!IsChunkAllocated(address + 4 + from, address + 4 + to))
+      throw MemoryNotAllocated();
+    auto begin = reinterpret_cast<const char *>(memory + address + 4 + from);
+    auto end = begin + (to - from);
+    while (begin != end && (*begin == ' ' || *begin == '\t')) ++begin;
+    if (begin != end && *begin == '+') ++begin;
+    if (type == PrimitiveVariableType::kInt64) {
+      int64_t result = 0;
+      if (std::from_chars(begin, end, result).ec != std::errc()) throw NumberParseError();
+      Push(static_cast<uint64_t>(result));
+      return;
+    }
+    // strtod skips any whitespace itself
+    if (begin == end || std::isspace(static_cast<unsigned char>(*begin))) throw NumberParseError();
+    // strtod needs terminated string
+    std::string text(begin, end);
+    char * parsed_end;
+    errno = 0;
+    double result = strtod(text.c_str(), &parsed_end);
+    if (parsed_end == text.c_str() || (errno == ERANGE && std::isinf(result))) throw NumberParseError();
+    uint64_t bits;
+    memcpy(&bits, &result, sizeof(bits));
+    Push(bits);
+  }
+
   void ToF64(PrimitiveVariableType type) {
     auto data = Pop();
     data = PruneNum(data, type);
@@ -491,8 +1187,10 @@ namespace run {
   void Tilda(PrimitiveVariableType type) {
     auto data = Pop();
     uint64_t result = 0;
-    uint64_t mask = PruneNum(~(0ull), type);
-    result = result & mask ^ mask;
+    if (type == PrimitiveVariableType::kBool)
+      result = !data;
+    else
+      result = ~data & PruneNum(~(0ull), type);
     Push(result);
   }
 
@@ -632,7 +1330,7 @@ namespace run {
         break;
       case PrimitiveVariableType::kF32: {
         float lhs_f = *reinterpret_cast<float*>(&lhs), rhs_f = *reinterpret_cast<float*>(&rhs);
-        float div = std::fmodf(lhs_f, rhs_f);
+        float div = std::fmod(lhs_f, rhs_f);
         result = *reinterpret_cast<uint32_t*>(&div);
       }
         break;
@@ -647,16 +1345,130 @@ namespace run {
     Push(result);
   }
 
+  void Power(PrimitiveVariableType type) {
+    auto [lhs, rhs] = PopBin();
+    DispatchElement(type, [&](auto * tag) {
+      using T = std::remove_pointer_t<decltype(tag)>;
+      T base = FromStack<T>(lhs), exponent = FromStack<T>(rhs);
+      if constexpr (std::is_floating_point_v<T>) {
+        Push(ToStack(static_cast<T>(std::pow(base, exponent))));
+      } else {
+        if constexpr (std::is_signed_v<T>) {
+          if (exponent < 0) {
+            // only 1 and -1 have integer powers below 0
+            if (base == 0) throw DivisionByZero();
+            T result = base == 1 ? 1 : base == -1 ? (exponent % 2 ? -1 : 1) : 0;
+            Push(ToStack(result));
+            return;
+          }
+        }
+        // Exponentiation by squaring, overflow wraps around as in multiplication
+        uint64_t result = 1, square = static_cast<uint64_t>(base);
+        for (uint64_t e = static_cast<uint64_t>(exponent); e; e >>= 1) {
+          if (e & 1) result *= square;
+          square *= square;
+        }
+        Push(ToStack(static_cast<T>(result)));
+      }
+    });
+  }
+
+  // Pushes f($arg) as value of type
+  template <typename F>
+  void UnaryMath(PrimitiveVariableType type, F f) {
+    auto data = Pop();
+    DispatchElement(type, [&](auto * tag) {
+      using T = std::remove_pointer_t<decltype(tag)>;
+      Push(ToStack(static_cast<T>(f(FromStack<T>(data)))));
+    });
+  }
+
+  void Abs(PrimitiveVariableType type) {
+    UnaryMath(type, [](auto x) {
+      using T = decltype(x);
+      if constexpr (std::is_unsigned_v<T>)
+        return x;
+      else if constexpr (std::is_integral_v<T>)
+        // negated as unsigned, so abs of minimal value wraps to itself instead of overflowing
+        return x < 0 ? static_cast<T>(0 - static_cast<std::make_unsigned_t<T>>(x)) : x;
+      else
+        return x < 0 ? -x : x;
+    });
+  }
+
+  void Fma(PrimitiveVariableType type) {
+    auto c = Pop();
+    auto [a, b] = PopBin();
+    if (type == PrimitiveVariableType::kF32)
+      Push(ToStack(std::fma(FromStack<float>(a), FromStack<float>(b), FromStack<float>(c))));
+    else
+      Push(ToStack(std::fma(FromStack<double>(a), FromStack<double>(b), FromStack<double>(c))));
+  }
+
   void BitwiseShiftLeft(PrimitiveVariableType type) {
     auto [val, sh] = PopBin();
     val <<= sh;
     Push(PruneNum(val, type));
   }
 
+  // Arithmetic for signed types
   void BitwiseShiftRight(PrimitiveVariableType type) {
     auto [val, sh] = PopBin();
-    val >>= sh;
-    Push(PruneNum(val, type));
+    DispatchElement(type, [&](auto * tag) {
+      using T = std::remove_pointer_t<decltype(tag)>;
+      if constexpr (std::is_integral_v<T>) {
+        T value = FromStack<T>(val);
+        if (sh >= sizeof(T) * 8)
+          Push(ToStack(static_cast<T>(value < 0 ? -1 : 0)));
+        else
+          Push(ToStack(static_cast<T>(value >> sh)));
+      }
+    });
+  }
+
+  // Pushes f(bits of $arg) for integer type
+  template <typename F>
+  void BitOperation(PrimitiveVariableType type, F f) {
+    auto data = Pop();
+    DispatchElement(type, [&](auto * tag) {
+      using T = std::remove_pointer_t<decltype(tag)>;
+      if constexpr (std::is_integral_v<T>)
+        Push(f(static_cast<std::make_unsigned_t<T>>(data)));
+    });
+  }
+
+  template <typename U>
+  uint64_t CountLeadingZeros(U x) {
+    constexpr int kWidth = sizeof(U) * 8;
+    return x ? __builtin_clzll(x) - (64 - kWidth) : kWidth;
+  }
+
+  template <typename U>
+  uint64_t CountTrailingZeros(U x) {
+    return x ? __builtin_ctzll(x) : sizeof(U) * 8;
+  }
+
+  template <typename U>
+  U ByteSwap(U x) {
+    if constexpr (sizeof(U) == 8)
+      return __builtin_bswap64(x);
+    else if constexpr (sizeof(U) == 4)
+      return __builtin_bswap32(x);
+    else if constexpr (sizeof(U) == 2)
+      return __builtin_bswap16(x);
+    else
+      return x;
+  }
+
+  void Rotate(PrimitiveVariableType type, bool left) {
+    auto count = Pop();
+    BitOperation(type, [&](auto x) -> uint64_t {
+      using U = decltype(x);
+      constexpr uint64_t kWidth = sizeof(U) * 8;
+      uint64_t shift = (left ? count : kWidth - count % kWidth) % kWidth;
+      if (shift == 0) return x;
+      return static_cast<U>(x << shift | x >> (kWidth - shift));
+    });
   }
 
   void BitwiseAnd(PrimitiveVariableType type) {
@@ -870,6 +1682,12 @@ namespace run {
       case RPNOperatorType::kJz:
         Jz();
         break;
+      case RPNOperatorType::kJnz:
+        Jnz();
+        break;
+      case RPNOperatorType::kJumpTable:
+        JumpTable();
+        break;
       case RPNOperatorType::kPush:
         PushStack();
         break;
@@ -892,7 +1710,61 @@ namespace run {
         Read();
         break;
       case RPNOperatorType::kWrite:
-        Write();
+        if (type == PrimitiveVariableType::kUnknown)
+          Write();
+        else
+          WriteNumber(type);
+        break;
+      case RPNOperatorType::kMap:
+        Map();
+        break;
+      case RPNOperatorType::kReadBinary:
+        ReadBinary();
+        break;
+      case RPNOperatorType::kWriteBinary:
+        WriteBinary();
+        break;
+      case RPNOperatorType::kFormat:
+        Format(type);
+        break;
+      case RPNOperatorType::kParse:
+        Parse(type);
+        break;
+      case RPNOperatorType::kCompare:
+        Compare();
+        break;
+      case RPNOperatorType::kConcat:
+        Concat();
+        break;
+      case RPNOperatorType::kFind:
+        Find();
+        break;
+      case RPNOperatorType::kSubstring:
+        Substring();
+        break;
+      case RPNOperatorType::kHash:
+        Hash();
+        break;
+      case RPNOperatorType::kSort:
+        Sort(type);
+        break;
+      case RPNOperatorType::kArrayFill:
+        ArrayFill(type);
+        break;
+      case RPNOperatorType::kArrayCopy:
+        ArrayCopy();
+        break;
+      case RPNOperatorType::kSum:
+        Sum(type);
+        break;
+      case RPNOperatorType::kMin:
+        MinMax<false>(type);
+        break;
+      case RPNOperatorType::kMax:
+        MinMax<true>(type);
+        break;
+      case RPNOperatorType::kLowerBound:
+        LowerBound(type);
         break;
       case RPNOperatorType::kReturn:
         Return();
@@ -962,7 +1834,7 @@ namespace run {
         BitwiseShiftLeft(type);
         break;
       case RPNOperatorType::kBitwiseShiftRight:
-        BitwiseShiftLeft(type);
+        BitwiseShiftRight(type);
         break;
       case RPNOperatorType::kBitwiseAnd:
         BitwiseAnd(type);
@@ -973,6 +1845,54 @@ namespace run {
       case RPNOperatorType::kBitwiseXor:
         BitwiseXor(type);
         break;
+      case RPNOperatorType::kPower:
+        Power(type);
+        break;
+      case RPNOperatorType::kSqrt:
+        UnaryMath(type, [](auto x) { return std::sqrt(x); });
+        break;
+      case RPNOperatorType::kAbs:
+        Abs(type);
+        break;
+      case RPNOperatorType::kFloor:
+        UnaryMath(type, [](auto x) { return std::floor(x); });
+        break;
+      case RPNOperatorType::kCeil:
+        UnaryMath(type, [](auto x) { return std::ceil(x); });
+        break;
+      case RPNOperatorType::kExp:
+        UnaryMath(type, [](auto x) { return std::exp(x); });
+        break;
+      case RPNOperatorType::kLog:
+        UnaryMath(type, [](auto x) { return std::log(x); });
+        break;
+      case RPNOperatorType::kSin:
+        UnaryMath(type, [](auto x) { return std::sin(x); });
+        break;
+      case RPNOperatorType::kCos:
+        UnaryMath(type, [](auto x) { return std::cos(x); });
+        break;
+      case RPNOperatorType::kFma:
+        Fma(type);
+        break;
+      case RPNOperatorType::kPopcount:
+        BitOperation(type, [](auto x) -> uint64_t { return __builtin_popcountll(x); });
+        break;
+      case RPNOperatorType::kClz:
+        BitOperation(type, [](auto x) { return CountLeadingZeros(x); });
+        break;
+      case RPNOperatorType::kCtz:
+        BitOperation(type, [](auto x) { return CountTrailingZeros(x); });
+        break;
+      case RPNOperatorType::kRotateLeft:
+        Rotate(type, true);
+        break;
+      case RPNOperatorType::kRotateRight:
+        Rotate(type, false);
+        break;
+      case RPNOperatorType::kByteSwap:
+        BitOperation(type, [](auto x) -> uint64_t { return ByteSwap(x); });
+        break;
 
         // Logical operators
       case RPNOperatorType::kInvert:
@@ -1002,21 +1922,28 @@ namespace run {
 }
 
 int32_t Execute(const RPN & rpn_obj) {
-  run::AllocateChunk(0, run::STACK_SIZE);
-  run::func_sps[0].push_back(0);
+  run::Reset();
+  run::func_sps[0].push_back(run::sp);
   const std::vector<std::shared_ptr<RPNNode>> & rpn = rpn_obj.GetNodes();
   run::program_size = rpn.size();
-  for (run::pc = 0; run::pc < rpn.size(); ++run::pc) {
-    auto node = rpn[run::pc];
-    if (node->GetNodeType() == NodeType::kReferenceOperand)
-      throw ReferenceOperandMetError();
-    if (node->GetNodeType() == NodeType::kOperand)
-      run::stack.push_back(std::dynamic_pointer_cast<RPNOperand>(node)->GetValue());
-    else {
-      auto ptr = std::dynamic_pointer_cast<RPNOperator>(node);
-      run::HandleOperation(ptr->GetOperatorType(), ptr->GetVariableType());
+  try {
+    for (run::pc = 0; run::pc < rpn.size(); ++run::pc) {
+      auto node = rpn[run::pc];
+      if (node->GetNodeType() == NodeType::kReferenceOperand)
+        throw ReferenceOperandMetError();
+      if (node->GetNodeType() == NodeType::kOperand)
+        run::stack.push_back(std::dynamic_pointer_cast<RPNOperand>(node)->GetValue());
+      else {
+        auto ptr = std::dynamic_pointer_cast<RPNOperator>(node);
+        run::HandleOperation(ptr->GetOperatorType(), ptr->GetVariableType());
+      }
     }
   }
+  catch (...) {
+    run::FlushOutput();
+    throw;
+  }
+  run::FlushOutput();
 
   int32_t return_code = 0;
   if (run::memory[9])
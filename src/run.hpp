@@ -1,5 +1,29 @@
 #pragma once
 
 #include "generation.hpp"
+#include <vector>
 
 int32_t Execute(const RPN & rpn);
+
+// Interpreter internals, used directly by operation benchmarks
+namespace run {
+  constexpr uint32_t
+  STACK_SIZE = 1 * 1024 * 1024;
+  constexpr uint32_t
+  MAX_SIZE = 10 * 1024 * 1024;
+
+  // If set, write() goes to stdout immediately instead of being buffered
+  extern bool unbuffered_output;
+  // If set, read() stores line into array already in variable when it is long enough
+  extern bool reuse_read_buffers;
+  extern std::vector<uint64_t> stack;
+  extern uint64_t hp;
+  extern uint64_t pc;
+  extern uint64_t program_size;
+
+  // Clears all the state and allocates memory for stack
+  void Reset();
+  void Push(uint64_t data);
+  uint64_t Pop();
+  void HandleOperation(RPNOperatorType op, PrimitiveVariableType type);
+}
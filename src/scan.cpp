@@ -0,0 +1,266 @@
+#include "scan.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SCAN_X86 1
+#else
+#define SCAN_X86 0
+#endif
+
+// ==============
+// === Scalar ===
+// ==============
+
+size_t ScalarSkipWhitespace(std::string_view code, size_t index) {
+  while (index < code.size() && IsSpaceChar(code[index]))
+    ++index;
+  return index;
+}
+
+size_t ScalarSkipIdentifier(std::string_view code, size_t index) {
+  while (index < code.size() && IsIdentifierChar(code[index]))
+    ++index;
+  return index;
+}
+
+size_t ScalarSkipDigits(std::string_view code, size_t index) {
+  while (index < code.size() && IsDigitChar(code[index]))
+    ++index;
+  return index;
+}
+
+size_t ScalarFindStringSpecial(std::string_view code, size_t index, char quote) {
+  while (index < code.size() && code[index] != quote && code[index] != '\\' && code[index] != '\n' &&
+         static_cast<unsigned char>(code[index]) < 0x80)
+    ++index;
+  return index;
+}
+
+size_t ScalarFindCommentEnd(std::string_view code, size_t index) {
+  for (; index + 1 < code.size(); ++index)
+    if (code[index] == '*' && code[index + 1] == '/')
+      return index;
+  return std::string_view::npos;
+}
+
+#if SCAN_X86
+
+// Most runs are short, so first byte is checked before loading vectors
+
+// ============
+// === SSE2 ===
+// ============
+
+__attribute__((target("sse2")))
+uint32_t SSE2InRange(__m128i chunk, char low, char high) {
+  __m128i above = _mm_cmpgt_epi8(chunk, _mm_set1_epi8(static_cast<char>(low - 1)));
+  __m128i below = _mm_cmplt_epi8(chunk, _mm_set1_epi8(static_cast<char>(high + 1)));
+  return static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(above, below)));
+}
+
+__attribute__((target("sse2")))
+uint32_t SSE2Equal(__m128i chunk, char ch) {
+  return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(ch))));
+}
+
+__attribute__((target("sse2")))
+__m128i SSE2Load(std::string_view code, size_t index) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(code.data() + index));
+}
+
+__attribute__((target("sse2")))
+size_t SSE2SkipWhitespace(std::string_view code, size_t index) {
+  if (index < code.size() && !IsSpaceChar(code[index])) return index;
+  for (; index + 16 <= code.size(); index += 16) {
+    __m128i chunk = SSE2Load(code, index);
+    uint32_t space = SSE2Equal(chunk, ' ') | SSE2Equal(chunk, '\n') | SSE2Equal(chunk, '\t') | SSE2Equal(chunk, '\r');
+    if (uint32_t stop = ~space & 0xFFFF) return index + static_cast<size_t>(__builtin_ctz(stop));
+  }
+  return ScalarSkipWhitespace(code, index);
+}
+
+__attribute__((target("sse2")))
+size_t SSE2SkipIdentifier(std::string_view code, size_t index) {
+  if (index < code.size() && !IsIdentifierChar(code[index])) return index;
+  for (; index + 16 <= code.size(); index += 16) {
+    __m128i chunk = SSE2Load(code, index);
+    __m128i lower = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+    uint32_t identifier = SSE2InRange(lower, 'a', 'z') | SSE2InRange(chunk, '0', '9') | SSE2Equal(chunk, '_');
+    if (uint32_t stop = ~identifier & 0xFFFF) return index + static_cast<size_t>(__builtin_ctz(stop));
+  }
+  return ScalarSkipIdentifier(code, index);
+}
+
+__attribute__((target("sse2")))
+size_t SSE2SkipDigits(std::string_view code, size_t index) {
+  if (index < code.size() && !IsDigitChar(code[index])) return index;
+  for (; index + 16 <= code.size(); index += 16) {
+    if (uint32_t stop = ~SSE2InRange(SSE2Load(code, index), '0', '9') & 0xFFFF)
+      return index + static_cast<size_t>(__builtin_ctz(stop));
+  }
+  return ScalarSkipDigits(code, index);
+}
+
+__attribute__((target("sse2")))
+size_t SSE2FindStringSpecial(std::string_view code, size_t index, char quote) {
+  for (; index + 16 <= code.size(); index += 16) {
+    __m128i chunk = SSE2Load(code, index);
+    // high bit of non-ASCII byte is its sign
+    uint32_t special = SSE2Equal(chunk, quote) | SSE2Equal(chunk, '\\') | SSE2Equal(chunk, '\n') |
+      static_cast<uint32_t>(_mm_movemask_epi8(chunk));
+    if (special) return index + static_cast<size_t>(__builtin_ctz(special));
+  }
+  return ScalarFindStringSpecial(code, index, quote);
+}
+
+__attribute__((target("sse2")))
+size_t SSE2FindCommentEnd(std::string_view code, size_t index) {
+  for (; index + 17 <= code.size(); index += 16) {
+    uint32_t end = SSE2Equal(SSE2Load(code, index), '*') & SSE2Equal(SSE2Load(code, index + 1), '/');
+    if (end) return index + static_cast<size_t>(__builtin_ctz(end));
+  }
+  return ScalarFindCommentEnd(code, index);
+}
+
+// ============
+// === AVX2 ===
+// ============
+
+__attribute__((target("avx2")))
+uint32_t AVX2InRange(__m256i chunk, char low, char high) {
+  __m256i above = _mm256_cmpgt_epi8(chunk, _mm256_set1_epi8(static_cast<char>(low - 1)));
+  __m256i below = _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(high + 1)), chunk);
+  return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(above, below)));
+}
+
+__attribute__((target("avx2")))
+uint32_t AVX2Equal(__m256i chunk, char ch) {
+  return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(ch))));
+}
+
+__attribute__((target("avx2")))
+__m256i AVX2Load(std::string_view code, size_t index) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(code.data() + index));
+}
+
+__attribute__((target("avx2")))
+size_t AVX2SkipWhitespace(std::string_view code, size_t index) {
+  if (index < code.size() && !IsSpaceChar(code[index])) return index;
+  for (; index + 32 <= code.size(); index += 32) {
+    __m256i chunk = AVX2Load(code, index);
+    uint32_t space = AVX2Equal(chunk, ' ') | AVX2Equal(chunk, '\n') | AVX2Equal(chunk, '\t') | AVX2Equal(chunk, '\r');
+    if (uint32_t stop = ~space) return index + static_cast<size_t>(__builtin_ctz(stop));
+  }
+  return SSE2SkipWhitespace(code, index);
+}
+
+__attribute__((target("avx2")))
+size_t AVX2SkipIdentifier(std::string_view code, size_t index) {
+  if (index < code.size() && !IsIdentifierChar(code[index])) return index;
+  for (; index + 32 <= code.size(); index += 32) {
+    __m256i chunk = AVX2Load(code, index);
+    __m256i lower = _mm256_or_si256(chunk, _mm256_set1_epi8(0x20));
+    uint32_t identifier = AVX2InRange(lower, 'a', 'z') | AVX2InRange(chunk, '0', '9') | AVX2Equal(chunk, '_');
+    if (uint32_t stop = ~identifier) return index + static_cast<size_t>(__builtin_ctz(stop));
+  }
+  return SSE2SkipIdentifier(code, index);
+}
+
+__attribute__((target("avx2")))
+size_t AVX2SkipDigits(std::string_view code, size_t index) {
+  if (index < code.size() && !IsDigitChar(code[index])) return index;
+  for (; index + 32 <= code.size(); index += 32) {
+    if (uint32_t stop = ~AVX2InRange(AVX2Load(code, index), '0', '9'))
+      return index + static_cast<size_t>(__builtin_ctz(stop));
+  }
+  return SSE2SkipDigits(code, index);
+}
+
+__attribute__((target("avx2")))
+size_t AVX2FindStringSpecial(std::string_view code, size_t index, char quote) {
+  for (; index + 32 <= code.size(); index += 32) {
+    __m256i chunk = AVX2Load(code, index);
+    uint32_t special = AVX2Equal(chunk, quote) | AVX2Equal(chunk, '\\') | AVX2Equal(chunk, '\n') |
+      static_cast<uint32_t>(_mm256_movemask_epi8(chunk));
+    if (special) return index + static_cast<size_t>(__builtin_ctz(special));
+  }
+  return SSE2FindStringSpecial(code, index, quote);
+}
+
+__attribute__((target("avx2")))
+size_t AVX2FindCommentEnd(std::string_view code, size_t index) {
+  for (; index + 33 <= code.size(); index += 32) {
+    uint32_t end = AVX2Equal(AVX2Load(code, index), '*') & AVX2Equal(AVX2Load(code, index + 1), '/');
+    if (end) return index + static_cast<size_t>(__builtin_ctz(end));
+  }
+  return SSE2FindCommentEnd(code, index);
+}
+
+#endif
+
+const ScanFunctions scalar_functions = {
+  ScalarSkipWhitespace, ScalarSkipIdentifier, ScalarSkipDigits, ScalarFindStringSpecial, ScalarFindCommentEnd
+};
+#if SCAN_X86
+const ScanFunctions sse2_functions = {
+  SSE2SkipWhitespace, SSE2SkipIdentifier, SSE2SkipDigits, SSE2FindStringSpecial, SSE2FindCommentEnd
+};
+const ScanFunctions avx2_functions = {
+  AVX2SkipWhitespace, AVX2SkipIdentifier, AVX2SkipDigits, AVX2FindStringSpecial, AVX2FindCommentEnd
+};
+#endif
+
+ScanLevel scan_level = ScanLevel::kScalar;
+ScanFunctions scan_functions = scalar_functions;
+
+ScanLevel GetBestScanLevel() {
+#if SCAN_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return ScanLevel::kAVX2;
+  if (__builtin_cpu_supports("sse2"))
+    return ScanLevel::kSSE2;
+#endif
+  return ScanLevel::kScalar;
+}
+
+ScanLevel GetScanLevel() {
+  return scan_level;
+}
+
+void SetScanLevel(ScanLevel level) {
+  scan_level = level;
+  switch (level) {
+    case ScanLevel::kScalar:
+      scan_functions = scalar_functions;
+      break;
+#if SCAN_X86
+    case ScanLevel::kSSE2:
+      scan_functions = sse2_functions;
+      break;
+    case ScanLevel::kAVX2:
+      scan_functions = avx2_functions;
+      break;
+#else
+    default:
+      scan_level = ScanLevel::kScalar;
+      scan_functions = scalar_functions;
+      break;
+#endif
+  }
+}
+
+// Selects the best level before main()
+const bool scan_level_selected = (SetScanLevel(GetBestScanLevel()), true);
+
+std::string ToString(ScanLevel level) {
+  switch (level) {
+    case ScanLevel::kScalar:
+      return "scalar";
+    case ScanLevel::kSSE2:
+      return "sse2";
+    case ScanLevel::kAVX2:
+      return "avx2";
+  }
+  return "";
+}
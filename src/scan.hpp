@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+// Instruction sets used by lexer to scan runs of bytes; kScalar works everywhere
+enum class ScanLevel : uint8_t {
+  kScalar, kSSE2, kAVX2
+};
+
+std::string ToString(ScanLevel level);
+
+ScanLevel GetBestScanLevel(); // best one supported by CPU, it is selected by default
+ScanLevel GetScanLevel();
+void SetScanLevel(ScanLevel level); // level has to be supported by CPU
+
+// Every one returns index of first byte at or after index which does not belong to the run
+struct ScanFunctions {
+  size_t (*skip_whitespace)(std::string_view code, size_t index);      // ' ', '\t', '\n', '\r'
+  size_t (*skip_identifier)(std::string_view code, size_t index);      // ASCII letters, digits and '_'
+  size_t (*skip_digits)(std::string_view code, size_t index);          // '0'-'9'
+  size_t (*find_string_special)(std::string_view code, size_t index,   // quote, '\\', '\n' or non-ASCII byte
+                                char quote);
+  size_t (*find_comment_end)(std::string_view code, size_t index);     // "*/", npos if there is none
+};
+
+extern ScanFunctions scan_functions;
+
+inline size_t SkipWhitespace(std::string_view code, size_t index) {
+  return scan_functions.skip_whitespace(code, index);
+}
+inline size_t SkipIdentifier(std::string_view code, size_t index) {
+  return scan_functions.skip_identifier(code, index);
+}
+inline size_t SkipDigits(std::string_view code, size_t index) {
+  return scan_functions.skip_digits(code, index);
+}
+inline size_t FindStringSpecial(std::string_view code, size_t index, char quote) {
+  return scan_functions.find_string_special(code, index, quote);
+}
+inline size_t FindCommentEnd(std::string_view code, size_t index) {
+  return scan_functions.find_comment_end(code, index);
+}
+
+// Locale-independent ASCII classification
+inline bool IsSpaceChar(char ch) {
+  return ch == ' ' || ch == '\n' || ch == '\t' || ch == '\r';
+}
+inline bool IsDigitChar(char ch) {
+  return '0' <= ch && ch <= '9';
+}
+inline bool IsLetterChar(char ch) {
+  char lower = static_cast<char>(ch | 0x20);
+  return 'a' <= lower && lower <= 'z';
+}
+inline bool IsIdentifierChar(char ch) {
+  return IsLetterChar(ch) || IsDigitChar(ch) || ch == '_';
+}
@@ -0,0 +1,70 @@
+#include "source.hpp"
+
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SourceFile::SourceFile(const std::string & path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return;
+  struct stat info;
+  if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+    size_ = static_cast<size_t>(info.st_size);
+    // mmap() of zero bytes fails, empty file is just empty text
+    if (size_ == 0) {
+      open_ = true;
+    } else {
+      void * ptr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (ptr != MAP_FAILED) {
+        data_ = static_cast<const char *>(ptr);
+        open_ = true;
+        // Whole file is scanned once from the beginning
+        madvise(ptr, size_, MADV_SEQUENTIAL);
+      } else
+        size_ = 0;
+    }
+  }
+  close(fd);
+}
+
+SourceFile::~SourceFile() {
+  if (data_)
+    munmap(const_cast<char *>(data_), size_);
+}
+
+size_t Utf8SequenceLength(std::string_view code, size_t index) {
+  auto byte = [&code](size_t i) { return static_cast<unsigned char>(code[i]); };
+  unsigned char lead = byte(index);
+  if (lead < 0x80) return 1;
+  size_t length;
+  uint32_t min;
+  if ((lead & 0xE0) == 0xC0) {
+    length = 2;
+    min = 0x80;
+  } else if ((lead & 0xF0) == 0xE0) {
+    length = 3;
+    min = 0x800;
+  } else if ((lead & 0xF8) == 0xF0) {
+    length = 4;
+    min = 0x10000;
+  } else
+    return 0;
+  if (index + length > code.size()) return 0;
+  for (size_t i = 1; i < length; ++i)
+    if ((byte(index + i) & 0xC0) != 0x80) return 0;
+  // Overlong encodings, surrogates and values above U+10FFFF are not valid
+  uint32_t value = static_cast<uint32_t>(DecodeUtf8(code, index, length));
+  if (value < min || value > 0x10FFFF || (0xD800 <= value && value <= 0xDFFF)) return 0;
+  return length;
+}
+
+wchar_t DecodeUtf8(std::string_view code, size_t index, size_t length) {
+  auto byte = [&code](size_t i) { return static_cast<uint32_t>(static_cast<unsigned char>(code[i])); };
+  if (length == 1) return static_cast<wchar_t>(byte(index));
+  uint32_t value = byte(index) & (0x7Fu >> length);
+  for (size_t i = 1; i < length; ++i)
+    value = (value << 6) | (byte(index + i) & 0x3F);
+  return static_cast<wchar_t>(value);
+}
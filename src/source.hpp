@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+// Source file mapped into memory, read-only; text is UTF-8 bytes as they are in the file
+class SourceFile {
+ public:
+  SourceFile(const std::string & path);
+  SourceFile(const SourceFile &) = delete;
+  SourceFile & operator = (const SourceFile &) = delete;
+  ~SourceFile();
+
+  bool IsOpen() const { return open_; }
+  std::string_view GetText() const { return { data_, size_ }; }
+
+ private:
+  bool open_ = false;
+  const char * data_ = nullptr;
+  size_t size_ = 0;
+};
+
+// Length of UTF-8 sequence starting at code[index], 0 if it is not a valid one
+size_t Utf8SequenceLength(std::string_view code, size_t index);
+
+// Code point of valid UTF-8 sequence of given length starting at code[index]
+wchar_t DecodeUtf8(std::string_view code, size_t index, size_t length);
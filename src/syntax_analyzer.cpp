@@ -3,7 +3,9 @@
 #include "lexeme.hpp"
 #include "TID.hpp"
 #include "operators.hpp"
+#include <algorithm>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 #include "casts.hpp"
@@ -17,7 +19,7 @@
 #if defined(DEBUG_ACTIVE) && DEBUG_ACTIVE
 #include <iostream>
 void debug_out() { std::wcerr << std::endl; }
-template <typename Head, typename... Tail> void debug_out(Head H, Tail... T) { std::wcerr << L" " << H; debug_out(T...);}
+template <typename Head, typename... Tail> void debug_out(Head H, Tail... T) { std::wcerr << " " << H; debug_out(T...);}
 #define debug(...) std::wcerr << "[" << __LINE__ << "]:", debug_out(__VA_ARGS__)
 #else
 #define debug(...) 42
@@ -27,37 +29,95 @@ constexpr uint64_t NULLPTR = 0;
 
 std::vector<std::shared_ptr<TIDVariableType>> scope_return_type;
 uint32_t surrounding_loop_count = 0;
+uint32_t surrounding_switch_count = 0;
 
-std::vector<Lexeme> _lexemes;
-size_t _lexeme_index;
+// Jumps out of && and || chain which is a condition of a branch, so its value is not materialized
+struct BranchFusion {
+  std::vector<uint64_t> true_jumps;   // operands of jumps taken when condition is true
+  std::vector<uint64_t> false_jumps;  // operands of jumps taken when condition is false
+};
+// Set by Condition(), taken by the first Priority2() so nested expressions are not fused
+BranchFusion * fusion = nullptr;
+
+// Lexemes are pulled one by one; current one is a cheap copy (type, symbol, index)
+Lexer * _lexer;
 bool eof;
 Lexeme lexeme;
 TID tid;
 
+// Function bodies are reused from cache if it is given
+ParseCache * parse_cache = nullptr;
+std::map<std::string, CachedFunction> next_cached_functions;
+uint64_t context_hash;                    // of lexemes outside of function bodies so far
+uint32_t function_body_depth = 0;
+std::vector<std::string> defined_functions;
+
+// Consumed lexemes are appended here while it is set
+std::vector<Lexeme> * captured_lexemes = nullptr;
+
+void HashLexeme(const Lexeme & hashed) {
+  context_hash = (context_hash ^ (static_cast<uint64_t>(hashed.GetSymbol()) << 8 |
+                                  static_cast<uint64_t>(hashed.GetType()))) * 1099511628211ull;
+}
+
 void GetNext() {
-  _lexeme_index++;
-  if (_lexeme_index >= _lexemes.size()) {
+  if (captured_lexemes)
+    captured_lexemes->push_back(lexeme);
+  if (!_lexer->GetNext(lexeme)) {
     eof = true;
-    lexeme = Lexeme(LexemeType::kNull, L"", lexeme.GetIndex() + lexeme.GetValue().size());
-  } else
-    lexeme = _lexemes[_lexeme_index];
+    lexeme = Lexeme(LexemeType::kNull, kEmptySymbol, lexeme.GetIndex() + lexeme.GetValue().size());
+  } else if (lexeme.GetType() == LexemeType::kUnknown)
+    throw UnknownLexeme(lexeme.GetIndex(), lexeme.GetValue());
+  if (parse_cache && function_body_depth == 0)
+    HashLexeme(lexeme);
 }
 
 void Program();
 
-std::map<std::wstring, std::shared_ptr<RPN>> func_rpn;
-std::map<std::wstring, uint64_t> func_size;
+std::map<std::string, std::shared_ptr<RPN>> func_rpn;
+std::map<std::string, uint64_t> func_size;
 std::vector<std::shared_ptr<RPN>> rpn;
 
-RPN PerformSyntaxAnalysis(const std::vector<Lexeme> & code) {
-  if (code.empty()) return {};
-  _lexemes = code;
-  _lexeme_index = 0;
-  lexeme = code[0];
+void PerformSyntaxAnalysis(Lexer & lexer, ParseCache * cache) {
+  _lexer = &lexer;
+  parse_cache = cache;
+  context_hash = 14695981039346656037ull;
+  if (cache) {
+    cache->reused = cache->parsed = 0;
+    next_cached_functions.clear();
+  }
   eof = false;
-  scope_return_type.push_back(GetPrimitiveVariableType(PrimitiveVariableType::kInt32));
-  rpn.push_back(std::make_shared<RPN>());
-  Program();
+  GetNext();
+  if (!eof) {
+    scope_return_type.push_back(GetPrimitiveVariableType(PrimitiveVariableType::kInt32));
+    rpn.push_back(std::make_shared<RPN>());
+    Program();
+  }
+  // Functions which are gone are dropped from cache
+  if (cache)
+    cache->functions = std::move(next_cached_functions);
+  _lexer = nullptr;
+  parse_cache = nullptr;
+}
+
+void ResetSyntaxAnalysis() {
+  tid = TID();
+  rpn.clear();
+  func_rpn.clear();
+  func_size.clear();
+  scope_return_type.clear();
+  defined_functions.clear();
+  captured_lexemes = nullptr;
+  surrounding_loop_count = 0;
+  surrounding_switch_count = 0;
+  function_body_depth = 0;
+  fusion = nullptr;
+  eof = false;
+  lexeme = Lexeme();
+}
+
+RPN PerformLinking() {
+  if (rpn.empty()) return {};
   // In TID function scope is still open
   // This is size of global scope stack item
   uint64_t global_stack_size = tid.GetFunctionScopeMaxAddress();
@@ -76,10 +136,12 @@ RPN PerformSyntaxAnalysis(const std::vector<Lexeme> & code) {
       result.PushNode(std::move(node));
   }
   AddReturn(result);
-  std::map<std::wstring, uint64_t> pc_by_name;
+  std::map<std::string, uint64_t> pc_by_name;
+  pc_by_name["$global"] = 0;
   uint64_t pc = result.GetNodes().size();
   for (auto & [name, cur_rpn] : func_rpn) {
     pc_by_name[name] = pc;
+    pc_by_name[name + "$size"] = func_size[name];
     auto begin = pc;
     for (auto & node : cur_rpn->GetNodes()) {
       if (node->GetNodeType() == NodeType::kRelativeOperand) {
@@ -93,7 +155,7 @@ RPN PerformSyntaxAnalysis(const std::vector<Lexeme> & code) {
   }
   for (auto & node : result.GetNodes()) {
     if (node->GetNodeType() == NodeType::kReferenceOperand) {
-      std::wstring name = std::dynamic_pointer_cast<RPNReferenceOperand>(node)
+      std::string name = std::dynamic_pointer_cast<RPNReferenceOperand>(node)
         ->GetName();
       if (!pc_by_name.count(name))
         throw VariableNotFoundByInternalName();
@@ -113,7 +175,7 @@ void Expect(LexemeType type, LexemeType others...) {
   Expect(others);
 }
 
-void Expect(LexemeType type, const std::wstring & value) {
+void Expect(LexemeType type, std::string_view value) {
   if (eof || lexeme.GetType() != type || lexeme.GetValue() != value)
     throw UnexpectedLexeme(lexeme, type);
 }
@@ -121,10 +183,10 @@ void Expect(LexemeType type, const std::wstring & value) {
 bool IsLexeme(LexemeType type) {
   return !eof && lexeme.GetType() == type;
 }
-bool IsLexeme(LexemeType type, const std::wstring & value) {
+bool IsLexeme(LexemeType type, std::string_view value) {
   return !eof && lexeme.GetType() == type && lexeme.GetValue() == value;
 }
-bool IsLexeme(const std::wstring & value) {
+bool IsLexeme(std::string_view value) {
   return !eof && lexeme.GetValue() == value;
 }
 
@@ -133,14 +195,15 @@ void Block(bool add_scope);
 void Keyword();
 std::shared_ptr<TIDValue> Expression();
 void Struct();
-std::pair<std::wstring, std::shared_ptr<TIDVariableType>> VariableIdentifier(std::shared_ptr<TIDVariableType> & type);
-//std::vector<std::pair<std::wstring, std::pair<std::shared_ptr<TIDVariableType>, uint64_t>>> Definition();
+std::pair<std::string, std::shared_ptr<TIDVariableType>> VariableIdentifier(std::shared_ptr<TIDVariableType> & type);
+//std::vector<std::pair<std::string, std::pair<std::shared_ptr<TIDVariableType>, uint64_t>>> Definition();
 //void DefinitionAddToScope();
 uint64_t Definition();
-std::pair<std::wstring, std::shared_ptr<TIDVariableType>> VariableParameter();
-std::pair<std::vector<std::pair<std::wstring, std::shared_ptr<TIDVariableType>>>,
-  std::vector<std::pair<std::wstring, std::shared_ptr<TIDVariableType>>>> ParameterList();
-std::shared_ptr<TIDVariableType> Function(const std::wstring & name,
+std::pair<std::string, std::shared_ptr<TIDVariableType>> VariableParameter();
+std::pair<std::vector<std::pair<std::string, std::shared_ptr<TIDVariableType>>>,
+  std::vector<std::pair<std::string, std::shared_ptr<TIDVariableType>>>>
+    ParameterList(std::vector<std::vector<Lexeme>> & defaults);
+std::shared_ptr<TIDVariableType> Function(const std::string & name,
                                           const std::shared_ptr<TIDVariableType> & return_type);
 std::shared_ptr<TIDVariableType> Type(bool complete_type = false);
 std::shared_ptr<TIDVariableType> TypeNoConst();
@@ -150,20 +213,84 @@ std::shared_ptr<TIDValue> Size();
 std::shared_ptr<TIDValue> Sizeof();
 std::shared_ptr<TIDValue> Read();
 std::shared_ptr<TIDValue> Write();
+std::shared_ptr<TIDValue> Map();
+std::shared_ptr<TIDValue> ReadBinary();
+std::shared_ptr<TIDValue> WriteBinary();
+std::shared_ptr<TIDValue> Format();
+std::shared_ptr<TIDValue> ParseInt();
+std::shared_ptr<TIDValue> ParseFloat();
+std::shared_ptr<TIDValue> Compare();
+std::shared_ptr<TIDValue> Concat();
+std::shared_ptr<TIDValue> Find();
+std::shared_ptr<TIDValue> Substring();
+std::shared_ptr<TIDValue> Hash();
+std::shared_ptr<TIDValue> ArraySort();
+std::shared_ptr<TIDValue> ArrayFill();
+std::shared_ptr<TIDValue> ArrayCopy();
+std::shared_ptr<TIDValue> ArraySum();
+std::shared_ptr<TIDValue> ArrayMin();
+std::shared_ptr<TIDValue> ArrayMax();
+std::shared_ptr<TIDValue> LowerBound();
+template <RPNOperatorType op>
+std::shared_ptr<TIDValue> FloatIntrinsic();
+template <RPNOperatorType op>
+std::shared_ptr<TIDValue> Rounding();
+std::shared_ptr<TIDValue> Abs();
+std::shared_ptr<TIDValue> Fma();
+template <RPNOperatorType op>
+std::shared_ptr<TIDValue> BitCount();
+template <RPNOperatorType op>
+std::shared_ptr<TIDValue> Rotate();
+std::shared_ptr<TIDValue> ByteSwap();
+
+// Reserved words which are called like functions inside expressions
+const std::map<std::string, std::shared_ptr<TIDValue> (*)()> builtins = {
+  { "new", New }, { "delete", Delete }, { "size", Size }, { "sizeof", Sizeof },
+  { "read", Read }, { "write", Write }, { "mmap", Map },
+  { "readbin", ReadBinary }, { "writebin", WriteBinary }, { "tostr", Format },
+  { "parseint", ParseInt }, { "parsefloat", ParseFloat }, { "strcmp", Compare },
+  { "concat", Concat }, { "find", Find }, { "substr", Substring }, { "strhash", Hash },
+  { "arrsort", ArraySort }, { "arrfill", ArrayFill }, { "arrcopy", ArrayCopy }, { "arrsum", ArraySum },
+  { "arrmin", ArrayMin }, { "arrmax", ArrayMax }, { "lowerbound", LowerBound },
+  { "sqrt", FloatIntrinsic<RPNOperatorType::kSqrt> }, { "exp", FloatIntrinsic<RPNOperatorType::kExp> },
+  { "log", FloatIntrinsic<RPNOperatorType::kLog> }, { "sin", FloatIntrinsic<RPNOperatorType::kSin> },
+  { "cos", FloatIntrinsic<RPNOperatorType::kCos> }, { "floor", Rounding<RPNOperatorType::kFloor> },
+  { "ceil", Rounding<RPNOperatorType::kCeil> }, { "abs", Abs }, { "fma", Fma },
+  { "popcount", BitCount<RPNOperatorType::kPopcount> }, { "clz", BitCount<RPNOperatorType::kClz> },
+  { "ctz", BitCount<RPNOperatorType::kCtz> }, { "rotl", Rotate<RPNOperatorType::kRotateLeft> },
+  { "rotr", Rotate<RPNOperatorType::kRotateRight> }, { "bswap", ByteSwap }
+};
+
+// Builtins besides new, delete, size, sizeof, read and write are not reserved words but identifiers
+// predeclared in global scope: variable, function or struct of the same name shadows them
+bool IsBuiltin() {
+  if (!builtins.count(lexeme.GetValue())) return false;
+  if (IsLexeme(LexemeType::kReserved)) return true;
+  return IsLexeme(LexemeType::kIdentifier) && !tid.GetVariable(lexeme.GetValue()) &&
+         !tid.GetComplexStruct(lexeme.GetValue());
+}
 void If();
 void For();
 void Foreach();
 void While();
 void DoWhile();
+void Switch();
 /*void Try();
 void Throw();*/
 void Continue();
 void Break();
 void Return();
+void StoreReturnValue(const std::shared_ptr<TIDVariableType> & return_type);
+void DefaultArgument(const std::string & internal_name, const std::vector<Lexeme> & lexemes,
+                     const std::shared_ptr<TIDVariableType> & type);
+void CallPushedFunction(const std::string & internal_name, const std::shared_ptr<TIDVariableType> & return_type);
 void FunctionCall(const std::shared_ptr<TIDValue> & type);
+void SetJumps(const std::vector<uint64_t> & operands, uint64_t target);
+uint64_t PushJump(RPNOperatorType op);
+std::vector<uint64_t> Condition();
 std::shared_ptr<TIDValue> Priority1();
 std::shared_ptr<TIDValue> Priority2();
-std::shared_ptr<TIDValue> Priority3();
+std::shared_ptr<TIDValue> Priority3(std::vector<uint64_t> * false_jumps = nullptr);
 std::shared_ptr<TIDValue> Priority4();
 std::shared_ptr<TIDValue> Priority5();
 std::shared_ptr<TIDValue> Priority6();
@@ -172,6 +299,7 @@ std::shared_ptr<TIDValue> Priority8();
 std::shared_ptr<TIDValue> Priority9();
 std::shared_ptr<TIDValue> Priority10();
 std::shared_ptr<TIDValue> Priority11();
+std::shared_ptr<TIDValue> PriorityPower();
 std::shared_ptr<TIDValue> Priority12();
 std::shared_ptr<TIDValue> Priority13();
 std::shared_ptr<TIDValue> Priority14();
@@ -185,7 +313,7 @@ void LoadType(const std::shared_ptr<TIDVariableType> & type, bool need_reference
     PushNode(RPNOperator(RPNOperatorType::kLoad, GetTypeOfVariable(type)));
 }
 
-void ReplaceReferenceOperands(uint64_t l, uint64_t r, const std::wstring & from, uint64_t to) {
+void ReplaceReferenceOperands(uint64_t l, uint64_t r, const std::string & from, uint64_t to) {
   auto & nodes = rpn.back()->GetNodes();
   for (uint64_t i = l; i < r; ++i) {
     if (nodes[i]->GetNodeType() == NodeType::kReferenceOperand &&
@@ -215,23 +343,19 @@ void Program() {
 void Action() {
   debug("Action");
   debug(lexeme.GetValue());
-  bool reserved = IsLexeme(LexemeType::kReserved);
-  if (IsLexeme(LexemeType::kReserved, L"new") || IsLexeme(LexemeType::kReserved, L"delete") ||
-      IsLexeme(LexemeType::kReserved, L"size") || IsLexeme(LexemeType::kReserved, L"sizeof") ||
-      IsLexeme(LexemeType::kReserved, L"read") || IsLexeme(LexemeType::kReserved, L"write"))
-    reserved = false;
+  bool reserved = IsLexeme(LexemeType::kReserved) && !IsBuiltin();
   if (reserved || IsLexeme(LexemeType::kVariableType) ||
       (IsLexeme(LexemeType::kIdentifier) && tid.GetComplexStruct(lexeme.GetValue()) != nullptr))
     Keyword();
-  else if (IsLexeme(LexemeType::kPunctuation, L"{"))
+  else if (IsLexeme(LexemeType::kPunctuation, "{"))
     Block(true);
   else {
     std::shared_ptr<TIDValue> val;
-    if (!IsLexeme(LexemeType::kPunctuation, L";"))
+    if (!IsLexeme(LexemeType::kPunctuation, ";"))
       val = Expression();
     if (val->GetType())
       PushNode(RPNOperator(RPNOperatorType::kDump));
-    Expect(LexemeType::kPunctuation, L";");
+    Expect(LexemeType::kPunctuation, ";");
     GetNext();
   }
   debug("Exited action");
@@ -240,18 +364,18 @@ void Action() {
 void Block(bool add_scope) {
   debug("Block");
   if (add_scope) tid.AddScope();
-  if (!IsLexeme(LexemeType::kPunctuation, L"{")) {
+  if (!IsLexeme(LexemeType::kPunctuation, "{")) {
     Action();
     if (add_scope) tid.RemoveScope();
     return;
   }
-  Expect(LexemeType::kPunctuation, L"{");
+  Expect(LexemeType::kPunctuation, "{");
   GetNext();
-  while (!IsLexeme(LexemeType::kPunctuation, L"}")) {
+  while (!IsLexeme(LexemeType::kPunctuation, "}")) {
     debug("inside of a block");
     Action();
   }
-  Expect(LexemeType::kPunctuation, L"}");
+  Expect(LexemeType::kPunctuation, "}");
   if (add_scope) tid.RemoveScope();
   GetNext();
 }
@@ -264,28 +388,32 @@ void Keyword() {
     if (tid.GetComplexStruct(lexeme.GetValue()) == nullptr)
       throw UndeclaredIdentifier(lexeme);
   }
-  if (IsLexeme(L"for"))
+  if (IsLexeme("for"))
     For();
-  else if (IsLexeme(L"while"))
+  else if (IsLexeme("while"))
     While();
-  else if (IsLexeme(L"do"))
+  else if (IsLexeme("do"))
     DoWhile();
-  else if (IsLexeme(L"foreach"))
+  else if (IsLexeme("foreach"))
     Foreach();
-  else if (IsLexeme(L"if") || IsLexeme(L"elif") || IsLexeme(L"else"))
+  else if (IsLexeme("if") || IsLexeme("elif") || IsLexeme("else"))
     If();
-  else if (IsLexeme(L"return"))
+  else if (IsLexeme("switch"))
+    Switch();
+  else if (IsLexeme("case") || IsLexeme("default"))
+    throw CaseOutsideOfSwitch(lexeme);
+  else if (IsLexeme("return"))
     Return();
-  else if (IsLexeme(L"break"))
+  else if (IsLexeme("break"))
     Break();
-  else if (IsLexeme(L"continue"))
+  else if (IsLexeme("continue"))
     Continue();
-  else if (IsLexeme(L"struct")) {
+  else if (IsLexeme("struct")) {
     Struct();
     return;
-  } /* else if (IsLexeme(L"try"))
+  } /* else if (IsLexeme("try"))
     Try();
-  else if (IsLexeme(L"throw"))
+  else if (IsLexeme("throw"))
     Throw(); */
   else {
     Definition();
@@ -300,19 +428,19 @@ std::shared_ptr<TIDValue> Expression() {
 
 void Struct() {
   debug("Struct");
-  Expect(LexemeType::kReserved, L"struct");
+  Expect(LexemeType::kReserved, "struct");
   GetNext();
   Expect(LexemeType::kIdentifier);
-  std::wstring name = lexeme.GetValue();
+  std::string name = lexeme.GetValue();
   GetNext();
-  Expect(LexemeType::kPunctuation, L"{");
+  Expect(LexemeType::kPunctuation, "{");
   GetNext();
 
-  std::vector<std::pair<std::wstring, std::shared_ptr<TIDVariableType>>> result;
+  std::vector<std::pair<std::string, std::shared_ptr<TIDVariableType>>> result;
   auto begin = tid.GetNextAddress();
   tid.AddScope();
   uint64_t size = 0;
-  while (!IsLexeme(LexemeType::kPunctuation, L"}")) {
+  while (!IsLexeme(LexemeType::kPunctuation, "}")) {
     size += Definition();
   }
   for (std::shared_ptr<TIDVariable> var : tid.GetLastScopeVariables())
@@ -332,30 +460,31 @@ void Struct() {
   auto internal_name = std::dynamic_pointer_cast<TIDComplexVariableType>(complex_struct)->GetInternalName();
 
   // Add to tid pointer to that
-  std::wstring def_var_name = internal_name + L"$def";
+  std::string def_var_name = internal_name + "$def";
   tid.AddVariable(lexeme, def_var_name, SetParamsToType(DerivePointerFromType(complex_type), false, false));
   auto def_var = tid.GetVariable(def_var_name);
   assert(def_var);
   tid.LoadVariableAddress(def_var_name, *rpn.back());
   PushNode(RPNOperator(RPNOperatorType::kStoreDA, PrimitiveVariableType::kUint64));
 
-  Expect(LexemeType::kPunctuation, L"}");
+  Expect(LexemeType::kPunctuation, "}");
   GetNext();
 }
 
-std::pair<std::wstring, std::shared_ptr<TIDVariableType>> VariableIdentifier(std::shared_ptr<TIDVariableType> & type) {
+std::pair<std::string, std::shared_ptr<TIDVariableType>> VariableIdentifier(std::shared_ptr<TIDVariableType> & type) {
   debug("Variable Identifier");
   uint32_t pointer_count = 0;
-  while (IsLexeme(LexemeType::kOperator, L"*")) {
-    ++pointer_count;
+  // lexer reads "**" as one operator
+  while (IsLexeme(LexemeType::kOperator, "*") || IsLexeme(LexemeType::kOperator, "**")) {
+    pointer_count += IsLexeme(LexemeType::kOperator, "**") ? 2 : 1;
     GetNext();
   }
-  std::wstring name;
+  std::string name;
   std::shared_ptr<TIDVariableType> ptr;
-  if (IsLexeme(LexemeType::kParenthesis, L"(")) {
+  if (IsLexeme(LexemeType::kParenthesis, "(")) {
     GetNext();
     std::tie(name, ptr) = VariableIdentifier(type);
-    Expect(LexemeType::kParenthesis, L")");
+    Expect(LexemeType::kParenthesis, ")");
     GetNext();
   } else {
     Expect(LexemeType::kIdentifier);
@@ -365,15 +494,15 @@ std::pair<std::wstring, std::shared_ptr<TIDVariableType>> VariableIdentifier(std
   }
   while (pointer_count--)
     ptr = DerivePointerFromType(ptr);
-  while (IsLexeme(LexemeType::kBracket, L"[")) {
+  while (IsLexeme(LexemeType::kBracket, "[")) {
     GetNext();
     /*
-    if (!IsLexeme(LexemeType::kBracket, L"]")) {
+    if (!IsLexeme(LexemeType::kBracket, "]")) {
       std::shared_ptr<TIDValue> ind_val = Expression();
       Cast(ind_val, SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kUint32), true));
     }
     */
-    Expect(LexemeType::kBracket, L"]");
+    Expect(LexemeType::kBracket, "]");
     GetNext();
     ptr = DeriveArrayFromType(ptr);
   }
@@ -385,7 +514,7 @@ uint64_t Definition() {
   uint64_t result = 0;
   std::shared_ptr<TIDVariableType> type = Type(true);
   std::shared_ptr<TIDVariableType> var_type;
-  std::wstring name;
+  std::string name;
   if (IsLexeme(LexemeType::kIdentifier)) {
     name = lexeme.GetValue();
     GetNext();
@@ -397,11 +526,11 @@ uint64_t Definition() {
     if (type == nullptr)
       throw VoidNotExpected(lexeme);
     var_type = type;
-    while (IsLexeme(LexemeType::kBracket, L"[")) {
+    while (IsLexeme(LexemeType::kBracket, "[")) {
       GetNext();
       /* std::shared_ptr<TIDValue> ind_val = Expression();
       Cast(ind_val, SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kUint32), true)); */
-      Expect(LexemeType::kBracket, L"]");
+      Expect(LexemeType::kBracket, "]");
       GetNext();
       var_type = DeriveArrayFromType(var_type);
     }
@@ -420,79 +549,140 @@ uint64_t Definition() {
     assert(expr_type);
     tid.LoadVariableAddress(var->GetName(), *rpn.back());
     if (expr_type->GetType() == VariableType::kComplex) {
-      PushNode(RPNOperand(expr_type->GetSize()));
+      PushNode(RPNOperand(var_type->GetSize()));
       PushNode(RPNOperator(RPNOperatorType::kCopyFT));
     } else {
       PushNode(RPNOperator(RPNOperatorType::kStoreDA, GetTypeOfVariable(var_type)));
     }
   };
-  if (IsLexeme(LexemeType::kOperator, L"=")) {
+  if (IsLexeme(LexemeType::kOperator, "=")) {
     GetNext();
     Eq();
   }
-  while (IsLexeme(LexemeType::kPunctuation, L",")) {
+  while (IsLexeme(LexemeType::kPunctuation, ",")) {
     GetNext();
     tie(name, var_type) = VariableIdentifier(type);
     tid.AddVariable(lexeme, name, var_type);
     var = tid.GetVariable(name);
     assert(var);
     result += var_type->GetSize();
-    if (IsLexeme(LexemeType::kOperator, L"=")) {
+    if (IsLexeme(LexemeType::kOperator, "=")) {
       GetNext();
       Eq();
     }
   }
-  Expect(LexemeType::kPunctuation, L";");
+  Expect(LexemeType::kPunctuation, ";");
   GetNext();
   return result;
 }
 
-std::pair<std::wstring, std::shared_ptr<TIDVariableType>> VariableParameter() {
+std::pair<std::string, std::shared_ptr<TIDVariableType>> VariableParameter() {
   std::shared_ptr<TIDVariableType> type = Type();
   if (type == nullptr)
     throw VoidNotExpected(lexeme);
   return VariableIdentifier(type);
 }
 
-std::pair<std::vector<std::pair<std::wstring, std::shared_ptr<TIDVariableType>>>,
-  std::vector<std::pair<std::wstring, std::shared_ptr<TIDVariableType>>>> ParameterList() {
+std::pair<std::vector<std::pair<std::string, std::shared_ptr<TIDVariableType>>>,
+  std::vector<std::pair<std::string, std::shared_ptr<TIDVariableType>>>>
+    ParameterList(std::vector<std::vector<Lexeme>> & defaults) {
   bool started_default = false;
-  std::vector<std::pair<std::wstring, std::shared_ptr<TIDVariableType>>> params, default_params;
+  std::vector<std::pair<std::string, std::shared_ptr<TIDVariableType>>> params, default_params;
 
-  if (IsLexeme(LexemeType::kParenthesis, L")"))
+  if (IsLexeme(LexemeType::kParenthesis, ")"))
     return { params, default_params };
 
   while (true) {
     auto var = VariableParameter();
-    if (IsLexeme(LexemeType::kOperator, L"="))
+    if (IsLexeme(LexemeType::kOperator, "="))
       started_default = true;
     if (started_default) {
       default_params.push_back(var);
-      if (!IsLexeme(LexemeType::kOperator, L"=")) {
+      if (!IsLexeme(LexemeType::kOperator, "=")) {
         throw ExpectedDefaultParameter(lexeme);
       }
       GetNext();
+      // Value is only checked here, its lexemes are kept to be compiled into function once name of it is known
+      size_t start = rpn.back()->GetNodes().size();
+      captured_lexemes = &defaults.emplace_back();
       auto param_val = Expression();
-      Cast(param_val, SetConstToType(var.second, true));
+      captured_lexemes = nullptr;
+      if (!CanCast(param_val, SetConstToType(var.second, true)))
+        throw UnableToCast(param_val, SetConstToType(var.second, true));
+      rpn.back()->GetNodes().resize(start);
     } else {
       params.push_back(var);
     }
-    if (!IsLexeme(LexemeType::kPunctuation, L",")) break;
+    if (!IsLexeme(LexemeType::kPunctuation, ",")) break;
     GetNext();
   }
 
   return { params, default_params };
 }
 
-std::shared_ptr<TIDVariableType> Function(const std::wstring & name,
+// Lexemes of function body from current "{" to matching "}", read ahead without consuming them
+bool ReadBody(std::vector<std::pair<LexemeType, SymbolId>> & body) {
+  if (!IsLexeme(LexemeType::kPunctuation, "{"))
+    return false;
+  body.emplace_back(lexeme.GetType(), lexeme.GetSymbol());
+  size_t depth = 1;
+  Lexeme next;
+  try {
+    for (size_t ahead = 0; depth > 0; ++ahead) {
+      if (!_lexer->Peek(ahead, next))
+        return false;
+      body.emplace_back(next.GetType(), next.GetSymbol());
+      if (next.GetType() == LexemeType::kPunctuation && next.GetValue() == "{")
+        ++depth;
+      else if (next.GetType() == LexemeType::kPunctuation && next.GetValue() == "}")
+        --depth;
+    }
+  } catch (const LexicalAnalysisError &) {
+    // It is reported when parsing gets there
+    return false;
+  }
+  return true;
+}
+
+bool ReuseBody(const std::string & internal_name, uint64_t context,
+               const std::vector<std::pair<LexemeType, SymbolId>> & body) {
+  auto it = parse_cache->functions.find(internal_name);
+  if (it == parse_cache->functions.end() || it->second.context != context || it->second.body != body)
+    return false;
+  for (const auto & [name, nodes, size] : it->second.functions) {
+    auto function_rpn = std::make_shared<RPN>();
+    function_rpn->GetNodes() = nodes;
+    func_rpn[name] = function_rpn;
+    func_size[name] = size;
+  }
+  ++parse_cache->reused;
+  next_cached_functions[internal_name] = std::move(it->second);
+  return true;
+}
+
+// Function defined at first_defined and the ones nested in it are complete
+void CacheBody(uint64_t context, std::vector<std::pair<LexemeType, SymbolId>> && body, size_t first_defined) {
+  CachedFunction & cached = next_cached_functions[defined_functions[first_defined]];
+  cached.context = context;
+  cached.body = std::move(body);
+  cached.functions.clear();
+  for (size_t i = first_defined; i < defined_functions.size(); ++i) {
+    const std::string & name = defined_functions[i];
+    cached.functions.emplace_back(name, func_rpn[name]->GetNodes(), func_size[name]);
+  }
+  ++parse_cache->parsed;
+}
+
+std::shared_ptr<TIDVariableType> Function(const std::string & name,
                                           const std::shared_ptr<TIDVariableType> & return_type) {
   debug("Function");
 
 
-  Expect(LexemeType::kParenthesis, L"(");
+  Expect(LexemeType::kParenthesis, "(");
   GetNext();
-  auto parameters = ParameterList();
-  Expect(LexemeType::kParenthesis, L")");
+  std::vector<std::vector<Lexeme>> defaults;
+  auto parameters = ParameterList(defaults);
+  Expect(LexemeType::kParenthesis, ")");
   GetNext();
 
   std::vector<std::shared_ptr<TIDVariableType>>
@@ -529,24 +719,50 @@ std::shared_ptr<TIDVariableType> Function(const std::wstring & name,
   rpn.push_back(std::make_shared<RPN>());
   auto var = tid.GetVariable(name);
   assert(var);
-  func_rpn[var->GetInternalName()] = rpn.back();
-
-  if (!IsLexeme(LexemeType::kPunctuation, L";")) {
-    tid.AddFunctionScope(var->GetInternalName(), return_type);
-    scope_return_type.push_back(return_type);
-    for (auto & [var_name, var_type] : parameters.first)
-      tid.AddVariable(lexeme, var_name, var_type);
-    for (auto & [var_name, var_type] : parameters.second)
-      tid.AddVariable(lexeme, var_name, var_type);
-    auto temp_value = surrounding_loop_count;
-    surrounding_loop_count = 0;
-    Block(false);
-    surrounding_loop_count = temp_value;
-    scope_return_type.pop_back();
-    AddReturn(*rpn.back());
-    uint64_t stack_size = tid.GetFunctionScopeMaxAddress();
-    func_size[tid.GetVariable(name)->GetInternalName()] = stack_size;
+  const std::string & internal_name = var->GetInternalName();
+  for (size_t i = 0; i < defaults.size(); ++i)
+    DefaultArgument(internal_name + "$default" + std::to_string(i), defaults[i], parameters.second[i].second);
+  func_rpn[internal_name] = rpn.back();
+  size_t first_defined = defined_functions.size();
+  defined_functions.push_back(internal_name);
+
+  if (!IsLexeme(LexemeType::kPunctuation, ";")) {
+    // Only top-level functions are cached, nested ones depend on lexemes of the body around them
+    bool cached = parse_cache && function_body_depth == 0;
+    uint64_t context = context_hash;
+    std::vector<std::pair<LexemeType, SymbolId>> body;
+    if (cached && !ReadBody(body))
+      cached = false;
+    ++function_body_depth;
+    tid.AddFunctionScope(internal_name, return_type);
+    if (cached && ReuseBody(internal_name, context, body)) {
+      for (size_t i = 0; i < body.size(); ++i)
+        GetNext();
+    } else {
+      scope_return_type.push_back(return_type);
+      for (auto & [var_name, var_type] : parameters.first)
+        tid.AddVariable(lexeme, var_name, var_type);
+      for (auto & [var_name, var_type] : parameters.second)
+        tid.AddVariable(lexeme, var_name, var_type);
+      auto temp_value = surrounding_loop_count;
+      auto temp_switch_value = surrounding_switch_count;
+      surrounding_loop_count = 0;
+      surrounding_switch_count = 0;
+      Block(false);
+      surrounding_loop_count = temp_value;
+      surrounding_switch_count = temp_switch_value;
+      scope_return_type.pop_back();
+      AddReturn(*rpn.back());
+      uint64_t stack_size = tid.GetFunctionScopeMaxAddress();
+      func_size[internal_name] = stack_size;
+      if (cached)
+        CacheBody(context, std::move(body), first_defined);
+    }
     tid.RemoveFunctionScope();
+    --function_body_depth;
+    // Lexeme after the body became current inside of it
+    if (parse_cache && function_body_depth == 0)
+      HashLexeme(lexeme);
   } else {
     GetNext();
     PushNode(RPNOperator(RPNOperatorType::kReturn));
@@ -562,25 +778,29 @@ std::shared_ptr<TIDVariableType> Function(const std::wstring & name,
 std::shared_ptr<TIDVariableType> Type(bool complete_type) {
   debug("Type");
   bool _const = false, _ref = false;
-  if (IsLexeme(LexemeType::kReserved, L"const")) {
+  if (IsLexeme(LexemeType::kReserved, "const")) {
     GetNext();
     _const = true;
   }
   std::shared_ptr<TIDVariableType> ptr = TypeNoConst();
   if (complete_type) {
-    while (IsLexeme(LexemeType::kOperator, L"*") || IsLexeme(LexemeType::kBracket, L"[")) {
-      if (IsLexeme(LexemeType::kOperator, L"*")) {
+    while (IsLexeme(LexemeType::kOperator, "*") || IsLexeme(LexemeType::kOperator, "**") ||
+           IsLexeme(LexemeType::kBracket, "[")) {
+      if (IsLexeme(LexemeType::kOperator, "*")) {
         GetNext();
         ptr = DerivePointerFromType(ptr);
+      } else if (IsLexeme(LexemeType::kOperator, "**")) {
+        GetNext();
+        ptr = DerivePointerFromType(DerivePointerFromType(ptr));
       } else {
         GetNext();
-        Expect(LexemeType::kBracket, L"]");
+        Expect(LexemeType::kBracket, "]");
         GetNext();
         ptr = DeriveArrayFromType(ptr);
       }
     }
   }
-  if (IsLexeme(LexemeType::kOperator, L"&")) {
+  if (IsLexeme(LexemeType::kOperator, "&")) {
     GetNext();
     _ref = true;
   }
@@ -596,7 +816,7 @@ std::shared_ptr<TIDVariableType> TypeNoConst() {
   if (!IsLexeme(LexemeType::kVariableType) && !IsLexeme(LexemeType::kIdentifier))
     Expect(LexemeType::kVariableType);
   std::shared_ptr<TIDVariableType> ptr = nullptr;
-  if (lexeme.GetValue() != L"void") {
+  if (lexeme.GetValue() != "void") {
     PrimitiveVariableType primitive_type = FromWstringToPrimitiveType(lexeme.GetValue());
     if (primitive_type == PrimitiveVariableType::kUnknown) {
       ptr = tid.GetComplexStruct(lexeme.GetValue());
@@ -612,42 +832,34 @@ std::shared_ptr<TIDVariableType> TypeNoConst() {
 
 void If() {
   debug("If");
-  Expect(LexemeType::kReserved, L"if");
+  Expect(LexemeType::kReserved, "if");
   GetNext();
-  Expect(LexemeType::kParenthesis, L"(");
+  Expect(LexemeType::kParenthesis, "(");
   GetNext();
   std::vector<uint64_t> to_set_end;
-  std::shared_ptr<TIDValue> value = Expression();
-  Expect(LexemeType::kParenthesis, L")");
+  std::vector<uint64_t> next_jumps = Condition();
+  Expect(LexemeType::kParenthesis, ")");
   GetNext();
-  Cast(value, SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kBool), true));
-  uint64_t next_ind = rpn.back()->GetNodes().size();
-  PushNode(RPNRelativeOperand(0));
-  PushNode(RPNOperator(RPNOperatorType::kJz));
   Block(true);
   to_set_end.push_back(rpn.back()->GetNodes().size());
   PushNode(RPNRelativeOperand(0));
   PushNode(RPNOperator(RPNOperatorType::kJmp));
-  while (IsLexeme(LexemeType::kReserved, L"elif")) {
+  while (IsLexeme(LexemeType::kReserved, "elif")) {
     GetNext();
-    Expect(LexemeType::kParenthesis, L"(");
+    Expect(LexemeType::kParenthesis, "(");
     GetNext();
-    rpn.back()->GetNodes()[next_ind] = std::make_shared<RPNRelativeOperand>(rpn.back()->GetNodes().size());
-    value = Expression();
-    Cast(value, SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kBool), true));
-    Expect(LexemeType::kParenthesis, L")");
+    SetJumps(next_jumps, rpn.back()->GetNodes().size());
+    next_jumps = Condition();
+    Expect(LexemeType::kParenthesis, ")");
     GetNext();
-    next_ind = rpn.back()->GetNodes().size();
-    PushNode(RPNOperand(0));
-    PushNode(RPNOperator(RPNOperatorType::kJz));
     Block(true);
     to_set_end.push_back(rpn.back()->GetNodes().size());
     PushNode(RPNOperand(0));
     PushNode(RPNOperator(RPNOperatorType::kJmp));
   }
-  rpn.back()->GetNodes()[next_ind] = std::make_shared<RPNRelativeOperand>(rpn.back()->GetNodes().size());
-  if (IsLexeme(LexemeType::kReserved, L"else")) {
-    Expect(LexemeType::kReserved, L"else");
+  SetJumps(next_jumps, rpn.back()->GetNodes().size());
+  if (IsLexeme(LexemeType::kReserved, "else")) {
+    Expect(LexemeType::kReserved, "else");
     GetNext();
     Block(true);
   }
@@ -658,12 +870,12 @@ void If() {
 
 void For() {
   debug("For");
-  Expect(LexemeType::kReserved, L"for");
+  Expect(LexemeType::kReserved, "for");
   GetNext();
   tid.AddScope();
-  Expect(LexemeType::kParenthesis, L"(");
+  Expect(LexemeType::kParenthesis, "(");
   GetNext();
-  if (!IsLexeme(LexemeType::kPunctuation, L";")) {
+  if (!IsLexeme(LexemeType::kPunctuation, ";")) {
     auto name = lexeme.GetValue();
     if (IsLexeme(LexemeType::kVariableType) || tid.GetComplexStruct(name))
       Definition();
@@ -675,29 +887,21 @@ void For() {
     }
   } else
     GetNext();
-  std::shared_ptr<TIDValue> val;
   uint64_t expression_start = rpn.back()->GetNodes().size();
-  if (!IsLexeme(LexemeType::kPunctuation, L";")) {
-    val = Expression();
-    if (val)
-      Cast(val, SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kBool), true));
-  }
-  if (!val)
-    PushNode(RPNOperand(1));
-  uint64_t end_ind = rpn.back()->GetNodes().size();
-  PushNode(RPNOperand(0));
-  PushNode(RPNOperator(RPNOperatorType::kJz));
+  std::vector<uint64_t> end_jumps;
+  if (!IsLexeme(LexemeType::kPunctuation, ";"))
+    end_jumps = Condition();
   uint64_t start_ind = rpn.back()->GetNodes().size();
   PushNode(RPNOperand(0));
   PushNode(RPNOperator(RPNOperatorType::kJmp));
-  Expect(LexemeType::kPunctuation, L";");
+  Expect(LexemeType::kPunctuation, ";");
   GetNext();
   uint64_t incr_start = rpn.back()->GetNodes().size();
-  if (!IsLexeme(LexemeType::kParenthesis, L")")) {
+  if (!IsLexeme(LexemeType::kParenthesis, ")")) {
     auto incr_val = Expression();
     if (incr_val->GetType())
       PushNode(RPNOperator(RPNOperatorType::kDump));
-    while (IsLexeme(LexemeType::kPunctuation, L",")) {
+    while (IsLexeme(LexemeType::kPunctuation, ",")) {
       GetNext();
       incr_val = Expression();
       if (incr_val->GetType())
@@ -706,7 +910,7 @@ void For() {
   }
   PushNode(RPNRelativeOperand(expression_start));
   PushNode(RPNOperator(RPNOperatorType::kJmp));
-  Expect(LexemeType::kParenthesis, L")");
+  Expect(LexemeType::kParenthesis, ")");
   GetNext();
   uint64_t start = rpn.back()->GetNodes().size();
 
@@ -718,24 +922,24 @@ void For() {
   uint64_t end = rpn.back()->GetNodes().size();
   tid.RemoveScope();
   rpn.back()->GetNodes()[start_ind] = std::make_shared<RPNRelativeOperand>(start);
-  rpn.back()->GetNodes()[end_ind] = std::make_shared<RPNRelativeOperand>(end);
-  ReplaceReferenceOperands(start, end, L"continue", incr_start);
-  ReplaceReferenceOperands(start, end, L"break", end);
+  SetJumps(end_jumps, end);
+  ReplaceReferenceOperands(start, end, "continue", incr_start);
+  ReplaceReferenceOperands(start, end, "break", end);
   debug("Exited For");
 }
 
 // TODO
 void Foreach() {
-  Expect(LexemeType::kReserved, L"foreach");
+  Expect(LexemeType::kReserved, "foreach");
   GetNext();
   tid.AddScope();
-  Expect(LexemeType::kParenthesis, L"(");
+  Expect(LexemeType::kParenthesis, "(");
   GetNext();
   auto [iter_name, iter_type] = VariableParameter();
-  Expect(LexemeType::kReserved, L"of");
+  Expect(LexemeType::kReserved, "of");
   GetNext();
   std::shared_ptr<TIDValue> arr_type = Expression();
-  Expect(LexemeType::kParenthesis, L")");
+  Expect(LexemeType::kParenthesis, ")");
   //                   LMFAO
   if (arr_type->GetType()->GetType() != VariableType::kArray)
     throw TypeNotIterable(lexeme); // TODO: thrown lexeme is not the one needed lol (it's actually everywhere)
@@ -758,17 +962,13 @@ void Foreach() {
 }
 
 void While() {
-  Expect(LexemeType::kReserved, L"while");
+  Expect(LexemeType::kReserved, "while");
   GetNext();
-  Expect(LexemeType::kParenthesis, L"(");
+  Expect(LexemeType::kParenthesis, "(");
   GetNext();
   uint64_t expression_start = rpn.back()->GetNodes().size();
-  std::shared_ptr<TIDValue> val = Expression();
-  Expect(LexemeType::kParenthesis, L")");
-  Cast(val, SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kBool), true));
-  uint64_t end_ind = rpn.back()->GetNodes().size();
-  PushNode(RPNOperand(0));
-  PushNode(RPNOperator(RPNOperatorType::kJz));
+  std::vector<uint64_t> end_jumps = Condition();
+  Expect(LexemeType::kParenthesis, ")");
   GetNext();
   uint64_t start = rpn.back()->GetNodes().size();
   ++surrounding_loop_count;
@@ -777,108 +977,306 @@ void While() {
   PushNode(RPNRelativeOperand(expression_start));
   PushNode(RPNOperator(RPNOperatorType::kJmp));
   uint64_t end = rpn.back()->GetNodes().size();
-  rpn.back()->GetNodes()[end_ind] = std::make_shared<RPNRelativeOperand>(end);
-  ReplaceReferenceOperands(start, end, L"continue", expression_start);
-  ReplaceReferenceOperands(start, end, L"break", end);
+  SetJumps(end_jumps, end);
+  ReplaceReferenceOperands(start, end, "continue", expression_start);
+  ReplaceReferenceOperands(start, end, "break", end);
 
 }
 
 void DoWhile() {
-  Expect(LexemeType::kReserved, L"do");
+  Expect(LexemeType::kReserved, "do");
   uint64_t start = rpn.back()->GetNodes().size();
   GetNext();
   Block(true);
-  Expect(LexemeType::kReserved, L"while");
+  Expect(LexemeType::kReserved, "while");
   GetNext();
   uint64_t expression_start = rpn.back()->GetNodes().size();
-  Expect(LexemeType::kParenthesis, L"(");
+  Expect(LexemeType::kParenthesis, "(");
   GetNext();
-  std::shared_ptr<TIDValue> value = Expression();
-  Expect(LexemeType::kParenthesis, L")");
+  std::vector<uint64_t> end_jumps = Condition();
+  Expect(LexemeType::kParenthesis, ")");
   GetNext();
-  Expect(LexemeType::kPunctuation, L";");
-  Cast(value, SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kBool), true));
-  uint64_t end_ind = rpn.back()->GetNodes().size();
-  PushNode(RPNOperand(0));
-  PushNode(RPNOperator(RPNOperatorType::kJz));
+  Expect(LexemeType::kPunctuation, ";");
   PushNode(RPNRelativeOperand(start));
   PushNode(RPNOperator(RPNOperatorType::kJmp));
   uint64_t end = rpn.back()->GetNodes().size();
-  rpn.back()->GetNodes()[end_ind] = std::make_shared<RPNRelativeOperand>(end);
-  ReplaceReferenceOperands(start, end, L"continue", expression_start);
-  ReplaceReferenceOperands(start, end, L"break", end);
+  SetJumps(end_jumps, end);
+  ReplaceReferenceOperands(start, end, "continue", expression_start);
+  ReplaceReferenceOperands(start, end, "break", end);
   ++surrounding_loop_count;
   GetNext();
   --surrounding_loop_count;
 }
 
+struct SwitchCase {
+  uint64_t value;   // promoted to int64/uint64
+  uint64_t target;
+};
+
+// Dense cases (at least half of the range is covered) go to a jump table,
+// others to binary search which turns into linear checks at kMaxLinearCases
+constexpr size_t kMinJumpTableCases = 4;
+constexpr size_t kMaxLinearCases = 3;
+
+// Integer literal, possibly negated, or char literal
+uint64_t CaseLabel() {
+  bool negative = IsLexeme(LexemeType::kOperator, "-");
+  if (negative)
+    GetNext();
+  uint64_t value;
+  if (IsLexeme(LexemeType::kNumericLiteral)) {
+    PrimitiveVariableType type = lexeme.GetLiteralType();
+    if (type == PrimitiveVariableType::kF32 || type == PrimitiveVariableType::kF64)
+      throw CaseLabelNotLiteral(lexeme);
+    value = lexeme.GetLiteral();
+  } else if (IsLexeme(LexemeType::kCharLiteral) && !negative)
+    value = lexeme.GetLiteral();
+  else
+    throw CaseLabelNotLiteral(lexeme);
+  return negative ? -value : value;
+}
+
+// Jumps to case with value on top of RPN (which is dumped) by binary search over cases[l, r)
+void SwitchDecisionTree(const std::vector<SwitchCase> & cases, size_t l, size_t r,
+                        PrimitiveVariableType type, const std::shared_ptr<RPNNode> & default_target) {
+  if (r - l <= kMaxLinearCases) {
+    for (size_t i = l; i < r; ++i) {
+      PushNode(RPNOperator(RPNOperatorType::kDuplicate));
+      PushNode(RPNOperand(cases[i].value));
+      PushNode(RPNOperator(RPNOperatorType::kEqual, type));
+      uint64_t next = PushJump(RPNOperatorType::kJz);
+      PushNode(RPNOperator(RPNOperatorType::kDump));
+      PushNode(RPNRelativeOperand(cases[i].target));
+      PushNode(RPNOperator(RPNOperatorType::kJmp));
+      SetJumps({ next }, rpn.back()->GetNodes().size());
+    }
+    PushNode(RPNOperator(RPNOperatorType::kDump));
+    rpn.back()->PushNode(std::shared_ptr<RPNNode>(default_target));
+    PushNode(RPNOperator(RPNOperatorType::kJmp));
+    return;
+  }
+  size_t mid = (l + r) / 2;
+  PushNode(RPNOperator(RPNOperatorType::kDuplicate));
+  PushNode(RPNOperand(cases[mid].value));
+  PushNode(RPNOperator(RPNOperatorType::kLess, type));
+  uint64_t right = PushJump(RPNOperatorType::kJz);
+  SwitchDecisionTree(cases, l, mid, type, default_target);
+  SetJumps({ right }, rpn.back()->GetNodes().size());
+  SwitchDecisionTree(cases, mid, r, type, default_target);
+}
+
+// [value] [dispatch] jmp; bodies; [end] jmp; dispatch: ...; end:
+// Dispatch goes after bodies, as only then targets of cases are known
+void SwitchDispatch(std::vector<SwitchCase> & cases, PrimitiveVariableType type,
+                    const std::shared_ptr<RPNNode> & default_target) {
+  // signed values are compared with bias so that unsigned order matches the signed one
+  uint64_t bias = type == PrimitiveVariableType::kInt64 ? 1ull << 63 : 0;
+  std::sort(cases.begin(), cases.end(), [bias](const SwitchCase & lhs, const SwitchCase & rhs) {
+    return (lhs.value ^ bias) < (rhs.value ^ bias);
+  });
+  if (cases.size() < kMinJumpTableCases || cases.back().value - cases.front().value >= 2 * cases.size()) {
+    SwitchDecisionTree(cases, 0, cases.size(), type, default_target);
+    return;
+  }
+  // [value - low] [count] [table] kJumpTable; table: [target] kJmp for every value in [low, high], then default
+  uint64_t low = cases.front().value;
+  uint64_t count = cases.back().value - low + 1;
+  if (low != 0) {
+    PushNode(RPNOperand(low));
+    PushNode(RPNOperator(RPNOperatorType::kSubtract, PrimitiveVariableType::kUint64));
+  }
+  PushNode(RPNOperand(count));
+  PushNode(RPNRelativeOperand(rpn.back()->GetNodes().size() + 2));
+  PushNode(RPNOperator(RPNOperatorType::kJumpTable));
+  auto it = cases.begin();
+  for (uint64_t i = 0; i < count; ++i) {
+    if (it->value == low + i)
+      PushNode(RPNRelativeOperand((it++)->target));
+    else
+      rpn.back()->PushNode(std::shared_ptr<RPNNode>(default_target));
+    PushNode(RPNOperator(RPNOperatorType::kJmp));
+  }
+  rpn.back()->PushNode(std::shared_ptr<RPNNode>(default_target));
+  PushNode(RPNOperator(RPNOperatorType::kJmp));
+}
+
+void Switch() {
+  debug("Switch");
+  Expect(LexemeType::kReserved, "switch");
+  GetNext();
+  Expect(LexemeType::kParenthesis, "(");
+  GetNext();
+  std::shared_ptr<TIDValue> value = Expression();
+  if (!value->GetType() || value->GetType()->GetType() != VariableType::kPrimitive)
+    throw SwitchTypeNotIntegral(lexeme);
+  PrimitiveVariableType primitive_type = GetTypeOfVariable(value->GetType());
+  if (primitive_type == PrimitiveVariableType::kF32 || primitive_type == PrimitiveVariableType::kF64 ||
+      primitive_type == PrimitiveVariableType::kBool)
+    throw SwitchTypeNotIntegral(lexeme);
+  bool is_signed = primitive_type == PrimitiveVariableType::kInt8 || primitive_type == PrimitiveVariableType::kInt16 ||
+    primitive_type == PrimitiveVariableType::kInt32 || primitive_type == PrimitiveVariableType::kInt64;
+  PrimitiveVariableType type = is_signed ? PrimitiveVariableType::kInt64 : PrimitiveVariableType::kUint64;
+  Cast(value, SetConstToType(GetPrimitiveVariableType(type), true));
+  Expect(LexemeType::kParenthesis, ")");
+  GetNext();
+  uint64_t dispatch_ind = PushJump(RPNOperatorType::kJmp);
+  uint64_t start = rpn.back()->GetNodes().size();
+
+  Expect(LexemeType::kPunctuation, "{");
+  GetNext();
+  tid.AddScope();
+  std::vector<SwitchCase> cases;
+  std::set<uint64_t> labels;
+  // Without default, values with no case go to the end, same as break
+  std::shared_ptr<RPNNode> default_target = std::make_shared<RPNReferenceOperand>("break");
+  bool has_default = false;
+  ++surrounding_switch_count;
+  while (!IsLexeme(LexemeType::kPunctuation, "}")) {
+    if (IsLexeme(LexemeType::kReserved, "case")) {
+      do {
+        GetNext();
+        uint64_t label = CaseLabel();
+        if (!labels.insert(label).second)
+          throw DuplicateCaseLabel(lexeme);
+        cases.push_back({ label, rpn.back()->GetNodes().size() });
+        GetNext();
+      } while (IsLexeme(LexemeType::kPunctuation, ","));
+      Expect(LexemeType::kPunctuation, ":");
+      GetNext();
+    } else if (IsLexeme(LexemeType::kReserved, "default")) {
+      if (has_default)
+        throw DuplicateCaseLabel(lexeme);
+      has_default = true;
+      default_target = std::make_shared<RPNRelativeOperand>(rpn.back()->GetNodes().size());
+      GetNext();
+      Expect(LexemeType::kPunctuation, ":");
+      GetNext();
+    } else
+      Action();
+  }
+  --surrounding_switch_count;
+  tid.RemoveScope();
+  GetNext();
+  PushNode(RPNReferenceOperand("break"));
+  PushNode(RPNOperator(RPNOperatorType::kJmp));
+
+  SetJumps({ dispatch_ind }, rpn.back()->GetNodes().size());
+  SwitchDispatch(cases, type, default_target);
+  uint64_t end = rpn.back()->GetNodes().size();
+  ReplaceReferenceOperands(start, end, "break", end);
+  debug("Exited Switch");
+}
+
 void Continue() {
-  Expect(LexemeType::kReserved, L"continue");
+  Expect(LexemeType::kReserved, "continue");
   if (surrounding_loop_count == 0)
     throw LoopInstructionsOutsideOfLoop(lexeme);
   GetNext();
-  Expect(LexemeType::kPunctuation, L";");
-  PushNode(RPNReferenceOperand(L"continue"));
+  Expect(LexemeType::kPunctuation, ";");
+  PushNode(RPNReferenceOperand("continue"));
   PushNode(RPNOperator(RPNOperatorType::kJmp));
   GetNext();
 }
 
 void Break() {
-  Expect(LexemeType::kReserved, L"break");
-  if (surrounding_loop_count == 0)
+  Expect(LexemeType::kReserved, "break");
+  if (surrounding_loop_count == 0 && surrounding_switch_count == 0)
     throw LoopInstructionsOutsideOfLoop(lexeme);
   GetNext();
-  Expect(LexemeType::kPunctuation, L";");
-  PushNode(RPNReferenceOperand(L"break"));
+  Expect(LexemeType::kPunctuation, ";");
+  PushNode(RPNReferenceOperand("break"));
   PushNode(RPNOperator(RPNOperatorType::kJmp));
   GetNext();
 }
 
 void Return() {
-  Expect(LexemeType::kReserved, L"return");
+  Expect(LexemeType::kReserved, "return");
   GetNext();
   std::shared_ptr<TIDValue> value;
-  if (!IsLexeme(LexemeType::kPunctuation, L";"))
+  if (!IsLexeme(LexemeType::kPunctuation, ";"))
     value = Expression();
-  Expect(LexemeType::kPunctuation, L";");
-  Cast(value, SetConstToType(scope_return_type.back(), true));
-  if (scope_return_type.back()) {
-    PushNode(RPNOperand(8));
-    PushNode(RPNOperator(RPNOperatorType::kFromSP));
-    PushNode(RPNOperand(1));
-    PushNode(RPNOperator(RPNOperatorType::kStoreAD, PrimitiveVariableType::kBool));
+  Expect(LexemeType::kPunctuation, ";");
+  if (scope_return_type.back())
+    Cast(value, SetConstToType(scope_return_type.back(), true));
+  else
+    Cast(value, nullptr);
+  if (scope_return_type.back())
+    StoreReturnValue(scope_return_type.back());
+  PushNode(RPNOperator(RPNOperatorType::kReturn));
+  GetNext();
+}
 
-    PushNode(RPNOperand(9));
-    PushNode(RPNOperator(RPNOperatorType::kFromSP));
-    if (IsReference(scope_return_type.back())) {
-      PushNode(RPNOperand(scope_return_type.back()->GetSize()));
-      PushNode(RPNOperator(RPNOperatorType::kCopyFT));
-    } else {
-      PushNode(RPNOperator(RPNOperatorType::kStoreDA, GetTypeOfVariable(value->GetType())));
-    }
+// Value on top of the stack is stored into stack item of function as returned one
+void StoreReturnValue(const std::shared_ptr<TIDVariableType> & return_type) {
+  PushNode(RPNOperand(8));
+  PushNode(RPNOperator(RPNOperatorType::kFromSP));
+  PushNode(RPNOperand(1));
+  PushNode(RPNOperator(RPNOperatorType::kStoreAD, PrimitiveVariableType::kBool));
+
+  PushNode(RPNOperand(9));
+  PushNode(RPNOperator(RPNOperatorType::kFromSP));
+  if (return_type->GetType() == VariableType::kComplex) {
+    PushNode(RPNOperand(return_type->GetSize()));
+    PushNode(RPNOperator(RPNOperatorType::kCopyFT));
+  } else {
+    PushNode(RPNOperator(RPNOperatorType::kStoreDA,
+                         IsReference(return_type) ? PrimitiveVariableType::kUint64 : GetTypeOfVariable(return_type)));
   }
-  PushNode(RPNOperator(RPNOperatorType::kReturn));
+}
+
+// Default value of parameter is compiled once, in scope of function declaration, into function without
+// parameters that returns it; omitted argument is a call of it
+void DefaultArgument(const std::string & internal_name, const std::vector<Lexeme> & lexemes,
+                     const std::shared_ptr<TIDVariableType> & type) {
+  Lexer * declaration_lexer = _lexer;
+  Lexeme declaration_lexeme = lexeme;
+  bool declaration_eof = eof;
+  Lexer default_lexer(lexemes);
+  _lexer = &default_lexer;
+  eof = false;
+  // Lexemes were already hashed with the declaration
+  ++function_body_depth;
+
+  rpn.push_back(std::make_shared<RPN>());
+  tid.AddFunctionScope(internal_name, type);
   GetNext();
+  std::shared_ptr<TIDValue> value = Expression();
+  if (!eof)
+    throw UnexpectedLexeme(lexeme, LexemeType::kNull);
+  if (type->GetType() != VariableType::kComplex) // complex is always an address
+    Cast(value, SetConstToType(type, true));
+  StoreReturnValue(type);
+  PushNode(RPNOperator(RPNOperatorType::kReturn));
+  func_size[internal_name] = tid.GetFunctionScopeMaxAddress();
+  tid.RemoveFunctionScope();
+  func_rpn[internal_name] = rpn.back();
+  defined_functions.push_back(internal_name);
+  rpn.pop_back();
+
+  --function_body_depth;
+  _lexer = declaration_lexer;
+  lexeme = declaration_lexeme;
+  eof = declaration_eof;
 }
 
 std::shared_ptr<TIDValue> New() {
-  Expect(LexemeType::kReserved, L"new");
+  Expect(LexemeType::kReserved, "new");
   GetNext();
-  Expect(LexemeType::kParenthesis, L"(");
+  Expect(LexemeType::kParenthesis, "(");
   GetNext();
   std::shared_ptr<TIDVariableType> type = Type(true);
-  if (!type || (!IsLexeme(LexemeType::kParenthesis, L")") && !IsLexeme(LexemeType::kPunctuation, L",")))
-    throw NewIncorrectUsage(lexeme, type);
-  if (IsLexeme(LexemeType::kParenthesis, L")")) {
+  if (!type || (!IsLexeme(LexemeType::kParenthesis, ")") && !IsLexeme(LexemeType::kPunctuation, ",")))
+    throw BuiltinIncorrectUsage(lexeme, "new");
+  if (IsLexeme(LexemeType::kParenthesis, ")")) {
     GetNext();
     PushNode(RPNOperand(type->GetSize()));
     PushNode(RPNOperator(RPNOperatorType::kNew));
     return std::make_shared<TIDTemporaryValue>(SetConstToType(DerivePointerFromType(type), true));
   } else {
-    Expect(LexemeType::kPunctuation, L",");
+    Expect(LexemeType::kPunctuation, ",");
     GetNext();
     std::shared_ptr<TIDValue> ind = Expression();
-    Expect(LexemeType::kParenthesis, L")");
+    Expect(LexemeType::kParenthesis, ")");
     GetNext();
     Cast(ind, SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kUint32), true));
     PushNode(RPNOperator(RPNOperatorType::kDuplicate));
@@ -897,16 +1295,16 @@ std::shared_ptr<TIDValue> New() {
 }
 
 std::shared_ptr<TIDValue> Delete() {
-  Expect(LexemeType::kReserved, L"delete");
+  Expect(LexemeType::kReserved, "delete");
   GetNext();
-  Expect(LexemeType::kParenthesis, L"(");
+  Expect(LexemeType::kParenthesis, "(");
   GetNext();
   std::shared_ptr<TIDValue> val = Expression();
-  Expect(LexemeType::kParenthesis, L")");
+  Expect(LexemeType::kParenthesis, ")");
   auto type = val->GetType();
   auto var_type = type->GetType();
   if (var_type != VariableType::kPointer && var_type != VariableType::kArray)
-    throw DeleteIncorrectUsage(lexeme, val->GetType());
+    throw BuiltinIncorrectUsage(lexeme, "delete");
   GetNext();
   LoadIfReference(val, *rpn.back());
   std::shared_ptr<TIDVariableType> value_type;
@@ -914,7 +1312,7 @@ std::shared_ptr<TIDValue> Delete() {
     value_type = std::dynamic_pointer_cast<TIDPointerVariableType>(type)->GetValue();
     PushNode(RPNOperand(value_type->GetSize()));
   } else {
-    value_type = std::dynamic_pointer_cast<TIDPointerVariableType>(type)->GetValue();
+    value_type = std::dynamic_pointer_cast<TIDArrayVariableType>(type)->GetValue();
     PushNode(RPNOperator(RPNOperatorType::kDuplicate));
     PushNode(RPNOperator(RPNOperatorType::kLoad, PrimitiveVariableType::kUint32));
     PushNode(RPNOperand(value_type->GetSize()));
@@ -927,15 +1325,15 @@ std::shared_ptr<TIDValue> Delete() {
 }
 
 std::shared_ptr<TIDValue> Size() {
-  Expect(LexemeType::kReserved, L"size");
+  Expect(LexemeType::kReserved, "size");
   GetNext();
-  Expect(LexemeType::kParenthesis, L"(");
+  Expect(LexemeType::kParenthesis, "(");
   GetNext();
   std::shared_ptr<TIDValue> val = Expression();
-  Expect(LexemeType::kParenthesis, L")");
+  Expect(LexemeType::kParenthesis, ")");
   auto type = val->GetType();
   if (type->GetType() != VariableType::kArray)
-    throw SizeIncorrectUsage(lexeme, val->GetType());
+    throw BuiltinIncorrectUsage(lexeme, "size");
   GetNext();
   LoadIfReference(val, *rpn.back());
 //  PushNode(RPNOperator(RPNOperatorType::kLoad, PrimitiveVariableType::kUint64));
@@ -944,52 +1342,507 @@ std::shared_ptr<TIDValue> Size() {
 }
 
 std::shared_ptr<TIDValue> Sizeof() {
-  Expect(LexemeType::kReserved, L"sizeof");
+  Expect(LexemeType::kReserved, "sizeof");
   GetNext();
-  Expect(LexemeType::kParenthesis, L"(");
+  Expect(LexemeType::kParenthesis, "(");
   GetNext();
   std::shared_ptr<TIDVariableType> type = Type(true);
   if (!type)
     throw VoidNotExpected(lexeme);
-  Expect(LexemeType::kParenthesis, L")");
+  Expect(LexemeType::kParenthesis, ")");
   GetNext();
   PushNode(RPNOperand(type->GetSize()));
   return std::make_shared<TIDTemporaryValue>(SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kUint32), true));
 }
 
 std::shared_ptr<TIDValue> Read() {
-  Expect(LexemeType::kReserved, L"read");
+  Expect(LexemeType::kReserved, "read");
   GetNext();
-  Expect(LexemeType::kParenthesis, L"(");
+  Expect(LexemeType::kParenthesis, "(");
   GetNext();
   std::shared_ptr<TIDValue> val = Expression();
-  Expect(LexemeType::kParenthesis, L")");
+  Expect(LexemeType::kParenthesis, ")");
   auto type = val->GetType();
   if (!type || type->IsConst() || (val->GetValueType() == TIDValueType::kTemporary && !type->IsReference())
       || SetParamsToType(type, false, false) != DeriveArrayFromType(GetPrimitiveVariableType(PrimitiveVariableType::kChar)))
-    throw ReadIncorrectUsage(lexeme, type);
+    throw BuiltinIncorrectUsage(lexeme, "read");
   GetNext();
   PushNode(RPNOperator(RPNOperatorType::kRead));
   return std::make_shared<TIDTemporaryValue>(nullptr);
 }
 
 std::shared_ptr<TIDValue> Write() {
-  Expect(LexemeType::kReserved, L"write");
+  Expect(LexemeType::kReserved, "write");
+  GetNext();
+  Expect(LexemeType::kParenthesis, "(");
+  GetNext();
+  std::shared_ptr<TIDValue> val = Expression();
+  Expect(LexemeType::kParenthesis, ")");
+  auto type = val->GetType();
+  // numbers are formatted right into output
+  bool primitive = type && type->GetType() == VariableType::kPrimitive;
+  if (!type || (!primitive && SetParamsToType(type, false, false) !=
+                              DeriveArrayFromType(GetPrimitiveVariableType(PrimitiveVariableType::kChar))))
+    throw BuiltinIncorrectUsage(lexeme, "write");
+  GetNext();
+  LoadIfReference(val, *rpn.back());
+  if (primitive)
+    PushNode(RPNOperator(RPNOperatorType::kWrite, GetTypeOfVariable(type)));
+  else
+    PushNode(RPNOperator(RPNOperatorType::kWrite));
+  return std::make_shared<TIDTemporaryValue>(nullptr);
+}
+
+std::shared_ptr<TIDValue> Map() {
+  Expect(LexemeType::kIdentifier, "mmap");
   GetNext();
-  Expect(LexemeType::kParenthesis, L"(");
+  Expect(LexemeType::kParenthesis, "(");
   GetNext();
   std::shared_ptr<TIDValue> val = Expression();
-  Expect(LexemeType::kParenthesis, L")");
+  Expect(LexemeType::kParenthesis, ")");
   auto type = val->GetType();
   if (!type || SetParamsToType(type, false, false) !=
                DeriveArrayFromType(GetPrimitiveVariableType(PrimitiveVariableType::kChar)))
-    throw WriteIncorrectUsage(lexeme, type);
+    throw BuiltinIncorrectUsage(lexeme, "mmap");
   GetNext();
   LoadIfReference(val, *rpn.back());
-  PushNode(RPNOperator(RPNOperatorType::kWrite));
+  PushNode(RPNOperator(RPNOperatorType::kMap));
+  return std::make_shared<TIDTemporaryValue>(SetConstToType(
+      DeriveArrayFromType(GetPrimitiveVariableType(PrimitiveVariableType::kChar)), true));
+}
+
+bool IsPrimitiveArray(const std::shared_ptr<TIDVariableType> & type) {
+  return type && type->GetType() == VariableType::kArray &&
+         std::static_pointer_cast<TIDArrayVariableType>(type)->GetValue()->GetType() == VariableType::kPrimitive;
+}
+
+// Optional second argument of readbin/writebin: path to file; stdin/stdout if omitted
+void BinaryPath(const char * name) {
+  if (IsLexeme(LexemeType::kPunctuation, ",")) {
+    GetNext();
+    std::shared_ptr<TIDValue> path = Expression();
+    auto path_type = path->GetType();
+    if (!path_type || SetParamsToType(path_type, false, false) !=
+                      DeriveArrayFromType(GetPrimitiveVariableType(PrimitiveVariableType::kChar)))
+      throw BuiltinIncorrectUsage(lexeme, name);
+    LoadIfReference(path, *rpn.back());
+  } else
+    PushNode(RPNOperand(NULLPTR));
+  Expect(LexemeType::kParenthesis, ")");
+  GetNext();
+}
+
+std::shared_ptr<TIDValue> ReadBinary() {
+  Expect(LexemeType::kIdentifier, "readbin");
+  GetNext();
+  Expect(LexemeType::kParenthesis, "(");
+  GetNext();
+  std::shared_ptr<TIDValue> val = Expression();
+  auto type = val->GetType();
+  if (!type || type->IsConst() || (val->GetValueType() == TIDValueType::kTemporary && !type->IsReference())
+      || !IsPrimitiveArray(type))
+    throw BuiltinIncorrectUsage(lexeme, "readbin");
+  auto element_type = std::static_pointer_cast<TIDArrayVariableType>(type)->GetValue();
+  PushNode(RPNOperand(element_type->GetSize()));
+  BinaryPath("readbin");
+  PushNode(RPNOperator(RPNOperatorType::kReadBinary));
+  return std::make_shared<TIDTemporaryValue>(nullptr);
+}
+
+std::shared_ptr<TIDValue> WriteBinary() {
+  Expect(LexemeType::kIdentifier, "writebin");
+  GetNext();
+  Expect(LexemeType::kParenthesis, "(");
+  GetNext();
+  std::shared_ptr<TIDValue> val = Expression();
+  auto type = val->GetType();
+  if (!IsPrimitiveArray(type))
+    throw BuiltinIncorrectUsage(lexeme, "writebin");
+  LoadIfReference(val, *rpn.back());
+  auto element_type = std::static_pointer_cast<TIDArrayVariableType>(type)->GetValue();
+  PushNode(RPNOperand(element_type->GetSize()));
+  BinaryPath("writebin");
+  PushNode(RPNOperator(RPNOperatorType::kWriteBinary));
   return std::make_shared<TIDTemporaryValue>(nullptr);
 }
 
+std::shared_ptr<TIDValue> Format() {
+  Expect(LexemeType::kIdentifier, "tostr");
+  GetNext();
+  Expect(LexemeType::kParenthesis, "(");
+  GetNext();
+  std::shared_ptr<TIDValue> val = Expression();
+  Expect(LexemeType::kParenthesis, ")");
+  auto type = val->GetType();
+  if (!type || type->GetType() != VariableType::kPrimitive)
+    throw BuiltinIncorrectUsage(lexeme, "tostr");
+  GetNext();
+  LoadIfReference(val, *rpn.back());
+  PushNode(RPNOperator(RPNOperatorType::kFormat, GetTypeOfVariable(type)));
+  return std::make_shared<TIDTemporaryValue>(SetConstToType(
+      DeriveArrayFromType(GetPrimitiveVariableType(PrimitiveVariableType::kChar)), true));
+}
+
+// Optional argument that is index in char[]; missing is pushed if it's omitted
+void IndexArgument(uint64_t missing) {
+  if (IsLexeme(LexemeType::kPunctuation, ",")) {
+    GetNext();
+    Cast(Expression(), SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kUint32), true));
+  } else
+    PushNode(RPNOperand(missing));
+}
+
+constexpr uint64_t kEndOfString = 0xFFFFFFFF;
+
+// parseint/parsefloat(s[, from[, to]]): number in slice [from; to) of s
+void ParseArguments() {
+  std::string name = lexeme.GetValue();
+  GetNext();
+  Expect(LexemeType::kParenthesis, "(");
+  GetNext();
+  std::shared_ptr<TIDValue> val = Expression();
+  auto type = val->GetType();
+  if (!type || SetParamsToType(type, false, false) !=
+               DeriveArrayFromType(GetPrimitiveVariableType(PrimitiveVariableType::kChar)))
+    throw BuiltinIncorrectUsage(lexeme, name);
+  LoadIfReference(val, *rpn.back());
+  IndexArgument(0);
+  IndexArgument(kEndOfString);
+  Expect(LexemeType::kParenthesis, ")");
+  GetNext();
+}
+
+std::shared_ptr<TIDValue> ParseInt() {
+  Expect(LexemeType::kIdentifier, "parseint");
+  ParseArguments();
+  PushNode(RPNOperator(RPNOperatorType::kParse, PrimitiveVariableType::kInt64));
+  return std::make_shared<TIDTemporaryValue>(SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kInt64), true));
+}
+
+std::shared_ptr<TIDValue> ParseFloat() {
+  Expect(LexemeType::kIdentifier, "parsefloat");
+  ParseArguments();
+  PushNode(RPNOperator(RPNOperatorType::kParse, PrimitiveVariableType::kF64));
+  return std::make_shared<TIDTemporaryValue>(SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kF64), true));
+}
+
+// Argument of string builtin, which must be char[]
+void StringArgument(const char * name) {
+  std::shared_ptr<TIDValue> val = Expression();
+  auto type = val->GetType();
+  if (!type || SetParamsToType(type, false, false) !=
+               DeriveArrayFromType(GetPrimitiveVariableType(PrimitiveVariableType::kChar)))
+    throw BuiltinIncorrectUsage(lexeme, name);
+  LoadIfReference(val, *rpn.back());
+}
+
+// Parses "name(s1, s2" of string builtin with two char[] arguments
+void StringArguments(const char * name) {
+  Expect(LexemeType::kIdentifier, name);
+  GetNext();
+  Expect(LexemeType::kParenthesis, "(");
+  GetNext();
+  StringArgument(name);
+  Expect(LexemeType::kPunctuation, ",");
+  GetNext();
+  StringArgument(name);
+}
+
+std::shared_ptr<TIDValue> Compare() {
+  StringArguments("strcmp");
+  Expect(LexemeType::kParenthesis, ")");
+  GetNext();
+  PushNode(RPNOperator(RPNOperatorType::kCompare));
+  return std::make_shared<TIDTemporaryValue>(SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kInt32), true));
+}
+
+std::shared_ptr<TIDValue> Concat() {
+  StringArguments("concat");
+  Expect(LexemeType::kParenthesis, ")");
+  GetNext();
+  PushNode(RPNOperator(RPNOperatorType::kConcat));
+  return std::make_shared<TIDTemporaryValue>(SetConstToType(
+      DeriveArrayFromType(GetPrimitiveVariableType(PrimitiveVariableType::kChar)), true));
+}
+
+std::shared_ptr<TIDValue> Find() {
+  StringArguments("find");
+  IndexArgument(0);
+  Expect(LexemeType::kParenthesis, ")");
+  GetNext();
+  PushNode(RPNOperator(RPNOperatorType::kFind));
+  return std::make_shared<TIDTemporaryValue>(SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kInt64), true));
+}
+
+std::shared_ptr<TIDValue> Substring() {
+  Expect(LexemeType::kIdentifier, "substr");
+  GetNext();
+  Expect(LexemeType::kParenthesis, "(");
+  GetNext();
+  StringArgument("substr");
+  Expect(LexemeType::kPunctuation, ",");
+  IndexArgument(0);
+  IndexArgument(kEndOfString);
+  Expect(LexemeType::kParenthesis, ")");
+  GetNext();
+  PushNode(RPNOperator(RPNOperatorType::kSubstring));
+  return std::make_shared<TIDTemporaryValue>(SetConstToType(
+      DeriveArrayFromType(GetPrimitiveVariableType(PrimitiveVariableType::kChar)), true));
+}
+
+std::shared_ptr<TIDValue> Hash() {
+  Expect(LexemeType::kIdentifier, "strhash");
+  GetNext();
+  Expect(LexemeType::kParenthesis, "(");
+  GetNext();
+  StringArgument("strhash");
+  Expect(LexemeType::kParenthesis, ")");
+  GetNext();
+  PushNode(RPNOperator(RPNOperatorType::kHash));
+  return std::make_shared<TIDTemporaryValue>(SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kUint64), true));
+}
+
+// Parses "name(a" of array builtin; returns type of elements of a.
+// Elements must be primitive unless any_elements, and not const if writable
+std::shared_ptr<TIDVariableType> ArrayArgument(const char * name, bool writable, bool any_elements = false) {
+  Expect(LexemeType::kIdentifier, name);
+  GetNext();
+  Expect(LexemeType::kParenthesis, "(");
+  GetNext();
+  std::shared_ptr<TIDValue> val = Expression();
+  auto type = val->GetType();
+  if (!type || type->GetType() != VariableType::kArray)
+    throw BuiltinIncorrectUsage(lexeme, name);
+  auto element_type = std::static_pointer_cast<TIDArrayVariableType>(type)->GetValue();
+  if ((!any_elements && element_type->GetType() != VariableType::kPrimitive) ||
+      (writable && element_type->IsConst()))
+    throw BuiltinIncorrectUsage(lexeme, name);
+  LoadIfReference(val, *rpn.back());
+  return element_type;
+}
+
+// ", v" where v is casted to type of elements
+void ElementArgument(const std::shared_ptr<TIDVariableType> & element_type) {
+  Expect(LexemeType::kPunctuation, ",");
+  GetNext();
+  Cast(Expression(), SetParamsToType(element_type, true, false));
+}
+
+// Optional "[, from[, to]]" range of array, closing parenthesis
+void ArrayRangeArguments() {
+  IndexArgument(0);
+  IndexArgument(kEndOfString);
+  Expect(LexemeType::kParenthesis, ")");
+  GetNext();
+}
+
+std::shared_ptr<TIDValue> ArraySort() {
+  auto element_type = ArrayArgument("arrsort", true);
+  ArrayRangeArguments();
+  PushNode(RPNOperator(RPNOperatorType::kSort, GetTypeOfVariable(element_type)));
+  return std::make_shared<TIDTemporaryValue>(nullptr);
+}
+
+std::shared_ptr<TIDValue> ArrayFill() {
+  auto element_type = ArrayArgument("arrfill", true);
+  ElementArgument(element_type);
+  ArrayRangeArguments();
+  PushNode(RPNOperator(RPNOperatorType::kArrayFill, GetTypeOfVariable(element_type)));
+  return std::make_shared<TIDTemporaryValue>(nullptr);
+}
+
+std::shared_ptr<TIDValue> ArrayCopy() {
+  auto element_type = ArrayArgument("arrcopy", true, true);
+  Expect(LexemeType::kPunctuation, ",");
+  IndexArgument(0);
+  Expect(LexemeType::kPunctuation, ",");
+  GetNext();
+  std::shared_ptr<TIDValue> val = Expression();
+  auto type = val->GetType();
+  if (!type || type->GetType() != VariableType::kArray ||
+      SetConstToType(std::static_pointer_cast<TIDArrayVariableType>(type)->GetValue(), false) !=
+      SetConstToType(element_type, false))
+    throw BuiltinIncorrectUsage(lexeme, "arrcopy");
+  LoadIfReference(val, *rpn.back());
+  IndexArgument(0);
+  IndexArgument(kEndOfString);
+  Expect(LexemeType::kParenthesis, ")");
+  GetNext();
+  PushNode(RPNOperand(element_type->GetSize()));
+  PushNode(RPNOperator(RPNOperatorType::kArrayCopy));
+  return std::make_shared<TIDTemporaryValue>(nullptr);
+}
+
+std::shared_ptr<TIDValue> ArraySum() {
+  auto element_type = ArrayArgument("arrsum", false);
+  Expect(LexemeType::kParenthesis, ")");
+  GetNext();
+  auto type = GetTypeOfVariable(element_type);
+  PushNode(RPNOperator(RPNOperatorType::kSum, type));
+  PrimitiveVariableType sum_type = PrimitiveVariableType::kInt64;
+  if (type == PrimitiveVariableType::kF32 || type == PrimitiveVariableType::kF64)
+    sum_type = PrimitiveVariableType::kF64;
+  else if (type == PrimitiveVariableType::kUint8 || type == PrimitiveVariableType::kUint16 ||
+           type == PrimitiveVariableType::kUint32 || type == PrimitiveVariableType::kUint64)
+    sum_type = PrimitiveVariableType::kUint64;
+  return std::make_shared<TIDTemporaryValue>(SetConstToType(GetPrimitiveVariableType(sum_type), true));
+}
+
+std::shared_ptr<TIDValue> ArrayMin() {
+  auto element_type = ArrayArgument("arrmin", false);
+  Expect(LexemeType::kParenthesis, ")");
+  GetNext();
+  PushNode(RPNOperator(RPNOperatorType::kMin, GetTypeOfVariable(element_type)));
+  return std::make_shared<TIDTemporaryValue>(SetParamsToType(element_type, true, false));
+}
+
+std::shared_ptr<TIDValue> ArrayMax() {
+  auto element_type = ArrayArgument("arrmax", false);
+  Expect(LexemeType::kParenthesis, ")");
+  GetNext();
+  PushNode(RPNOperator(RPNOperatorType::kMax, GetTypeOfVariable(element_type)));
+  return std::make_shared<TIDTemporaryValue>(SetParamsToType(element_type, true, false));
+}
+
+std::shared_ptr<TIDValue> LowerBound() {
+  auto element_type = ArrayArgument("lowerbound", false);
+  ElementArgument(element_type);
+  ArrayRangeArguments();
+  PushNode(RPNOperator(RPNOperatorType::kLowerBound, GetTypeOfVariable(element_type)));
+  return std::make_shared<TIDTemporaryValue>(SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kInt64), true));
+}
+
+// Argument of math intrinsic, which must be a number
+std::shared_ptr<TIDValue> MathArgument(const std::string & name) {
+  std::shared_ptr<TIDValue> val = Expression();
+  auto type = val->GetType();
+  if (!type || type->GetType() != VariableType::kPrimitive || GetTypeOfVariable(type) == PrimitiveVariableType::kBool)
+    throw BuiltinIncorrectUsage(lexeme, name);
+  return val;
+}
+
+// f32 stays f32, other numbers are computed as f64
+std::shared_ptr<TIDVariableType> FloatTypeOf(const std::shared_ptr<TIDValue> & val) {
+  return SetConstToType(GetPrimitiveVariableType(GetTypeOfVariable(val->GetType()) == PrimitiveVariableType::kF32 ?
+                                                 PrimitiveVariableType::kF32 : PrimitiveVariableType::kF64), true);
+}
+
+// sqrt, exp, log, sin, cos
+template <RPNOperatorType op>
+std::shared_ptr<TIDValue> FloatIntrinsic() {
+  Expect(LexemeType::kIdentifier);
+  std::string name = lexeme.GetValue();
+  GetNext();
+  Expect(LexemeType::kParenthesis, "(");
+  GetNext();
+  auto val = MathArgument(name);
+  Expect(LexemeType::kParenthesis, ")");
+  GetNext();
+  auto type = FloatTypeOf(val);
+  Cast(val, type);
+  PushNode(RPNOperator(op, GetTypeOfVariable(type)));
+  return std::make_shared<TIDTemporaryValue>(type);
+}
+
+// floor, ceil; integers are returned as they are
+template <RPNOperatorType op>
+std::shared_ptr<TIDValue> Rounding() {
+  Expect(LexemeType::kIdentifier);
+  std::string name = lexeme.GetValue();
+  GetNext();
+  Expect(LexemeType::kParenthesis, "(");
+  GetNext();
+  auto val = MathArgument(name);
+  Expect(LexemeType::kParenthesis, ")");
+  GetNext();
+  auto type = SetParamsToType(val->GetType(), true, false);
+  LoadIfReference(val, *rpn.back());
+  auto primitive_type = GetTypeOfVariable(type);
+  if (primitive_type == PrimitiveVariableType::kF32 || primitive_type == PrimitiveVariableType::kF64)
+    PushNode(RPNOperator(op, primitive_type));
+  return std::make_shared<TIDTemporaryValue>(type);
+}
+
+std::shared_ptr<TIDValue> Abs() {
+  Expect(LexemeType::kIdentifier, "abs");
+  GetNext();
+  Expect(LexemeType::kParenthesis, "(");
+  GetNext();
+  auto val = MathArgument("abs");
+  Expect(LexemeType::kParenthesis, ")");
+  GetNext();
+  auto type = SetParamsToType(val->GetType(), true, false);
+  LoadIfReference(val, *rpn.back());
+  PushNode(RPNOperator(RPNOperatorType::kAbs, GetTypeOfVariable(type)));
+  return std::make_shared<TIDTemporaryValue>(type);
+}
+
+// Type is chosen by first argument, the rest are casted to it
+std::shared_ptr<TIDValue> Fma() {
+  Expect(LexemeType::kIdentifier, "fma");
+  GetNext();
+  Expect(LexemeType::kParenthesis, "(");
+  GetNext();
+  auto val = MathArgument("fma");
+  auto type = FloatTypeOf(val);
+  Cast(val, type);
+  for (int i = 0; i < 2; ++i) {
+    Expect(LexemeType::kPunctuation, ",");
+    GetNext();
+    Cast(MathArgument("fma"), type);
+  }
+  Expect(LexemeType::kParenthesis, ")");
+  GetNext();
+  PushNode(RPNOperator(RPNOperatorType::kFma, GetTypeOfVariable(type)));
+  return std::make_shared<TIDTemporaryValue>(type);
+}
+
+// Parses "name(x" of bit intrinsic, x is casted to integer type that is returned
+std::shared_ptr<TIDVariableType> BitArgument() {
+  Expect(LexemeType::kIdentifier);
+  std::string name = lexeme.GetValue();
+  GetNext();
+  Expect(LexemeType::kParenthesis, "(");
+  GetNext();
+  std::shared_ptr<TIDValue> val = Expression();
+  auto type = BitOperationType(val);
+  if (!type)
+    throw BuiltinIncorrectUsage(lexeme, name);
+  Cast(val, type);
+  return type;
+}
+
+// popcount, clz, ctz
+template <RPNOperatorType op>
+std::shared_ptr<TIDValue> BitCount() {
+  auto type = BitArgument();
+  Expect(LexemeType::kParenthesis, ")");
+  GetNext();
+  PushNode(RPNOperator(op, GetTypeOfVariable(type)));
+  return std::make_shared<TIDTemporaryValue>(SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kInt32), true));
+}
+
+// rotl, rotr
+template <RPNOperatorType op>
+std::shared_ptr<TIDValue> Rotate() {
+  auto type = BitArgument();
+  Expect(LexemeType::kPunctuation, ",");
+  GetNext();
+  Cast(Expression(), SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kUint32), true));
+  Expect(LexemeType::kParenthesis, ")");
+  GetNext();
+  PushNode(RPNOperator(op, GetTypeOfVariable(type)));
+  return std::make_shared<TIDTemporaryValue>(type);
+}
+
+std::shared_ptr<TIDValue> ByteSwap() {
+  auto type = BitArgument();
+  Expect(LexemeType::kParenthesis, ")");
+  GetNext();
+  PushNode(RPNOperator(RPNOperatorType::kByteSwap, GetTypeOfVariable(type)));
+  return std::make_shared<TIDTemporaryValue>(type);
+}
+
 void FunctionCall(const std::shared_ptr<TIDValue> & val) {
   debug("Function Call");
   auto type = val->GetType();
@@ -998,51 +1851,119 @@ void FunctionCall(const std::shared_ptr<TIDValue> & val) {
   std::shared_ptr<TIDFunctionVariableType> func_type = std::dynamic_pointer_cast<TIDFunctionVariableType>(type);
   const std::vector<std::shared_ptr<TIDVariableType>> & params = func_type->GetParameters();
   const std::vector<std::shared_ptr<TIDVariableType>> & default_params = func_type->GetDefaultParameters();
+  auto GetParameter = [&params, &default_params](size_t index) -> std::shared_ptr<TIDVariableType> {
+    if (index < params.size()) return params[index];
+    if (index - params.size() < default_params.size()) return default_params[index - params.size()];
+    return nullptr;
+  };
+
+  // function is called by its internal name, address of its variable is not needed
+  PushNode(RPNOperator(RPNOperatorType::kDump));
 
-  Expect(LexemeType::kParenthesis, L"(");
+  Expect(LexemeType::kParenthesis, "(");
   GetNext();
   std::vector<std::shared_ptr<TIDValue>> provided;
-  if (!IsLexeme(LexemeType::kParenthesis, L")")) {
-    std::shared_ptr<TIDValue> value = Expression();
-    provided.push_back(value);
-    while (IsLexeme(LexemeType::kPunctuation, L",")) {
-      GetNext();
-      value = Expression();
+  bool matches = true;
+  if (!IsLexeme(LexemeType::kParenthesis, ")")) {
+    while (true) {
+      std::shared_ptr<TIDValue> value = Expression();
       provided.push_back(value);
+      auto param_type = GetParameter(provided.size() - 1);
+      if (!param_type || !CanCast(value, SetConstToType(param_type, true)))
+        matches = false;
+      else if (param_type->GetType() != VariableType::kComplex) // complex is always an address
+        Cast(value, SetConstToType(param_type, true));
+      if (!IsLexeme(LexemeType::kPunctuation, ",")) break;
+      GetNext();
     }
   }
-  Expect(LexemeType::kParenthesis, L")");
+  Expect(LexemeType::kParenthesis, ")");
   GetNext();
+  if (!matches || provided.size() < params.size())
+    throw FunctionParameterListDoesNotMatch(lexeme, func_type, provided);
 
-  size_t param_index = 0, default_param_index = 0;
-  for (const std::shared_ptr<TIDValue> & provided_val : provided) {
-    if (param_index == params.size()) {
-      if (default_param_index == default_params.size() ||
-          !CanCast(provided_val, SetConstToType(default_params[default_param_index++], true)))
-        throw FunctionParameterListDoesNotMatch(lexeme, func_type, provided);
+  // Omitted arguments get their default values from functions they are compiled into
+  std::string internal_name = std::dynamic_pointer_cast<TIDVariable>(val)->GetInternalName();
+  for (size_t i = provided.size(); i < params.size() + default_params.size(); ++i) {
+    std::string default_name = internal_name + "$default" + std::to_string(i - params.size());
+    PushNode(RPNReferenceOperand(default_name + "$size"));
+    PushNode(RPNReferenceOperand(default_name));
+    PushNode(RPNOperator(RPNOperatorType::kPush));
+    CallPushedFunction(default_name, GetParameter(i));
+  }
+
+  // Arguments are on the stack, now new stack item is pushed and they are stored into it
+  auto return_type = func_type->GetReturnType();
+  std::vector<uint64_t> offsets;
+  uint64_t offset = 8 + (return_type ? return_type->GetSize() + 1 : 0);
+  for (size_t i = 0; i < params.size() + default_params.size(); ++i) {
+    offsets.push_back(offset);
+    offset += GetParameter(i)->GetSize();
+  }
+  PushNode(RPNReferenceOperand(internal_name + "$size"));
+  PushNode(RPNReferenceOperand(internal_name));
+  PushNode(RPNOperator(RPNOperatorType::kPush));
+  for (size_t i = params.size() + default_params.size(); i-- > 0;) {
+    auto param_type = GetParameter(i);
+    PushNode(RPNOperand(offsets[i]));
+    PushNode(RPNOperator(RPNOperatorType::kFromSP));
+    if (param_type->GetType() == VariableType::kComplex) {
+      PushNode(RPNOperand(param_type->GetSize()));
+      PushNode(RPNOperator(RPNOperatorType::kCopyFT));
     } else {
-      if (!CanCast(provided_val,
-                   SetConstToType(params[param_index++], true)))
-        throw FunctionParameterListDoesNotMatch(lexeme, func_type, provided);
+      PushNode(RPNOperator(RPNOperatorType::kStoreDA,
+                           IsReference(param_type) ? PrimitiveVariableType::kUint64 : GetTypeOfVariable(param_type)));
     }
   }
-  if (param_index < params.size())
-    throw FunctionParameterListDoesNotMatch(lexeme, func_type, provided);
 
-  PushNode(RPNOperand(func_size[std::dynamic_pointer_cast<TIDVariable>(val)->GetInternalName()]));
-  PushNode(RPNOperator(RPNOperatorType::kPush));
+  CallPushedFunction(internal_name, return_type);
 }
 
-const size_t signs1_sz = /*12*/ 11; // no power (**) 'cause it messes with pointers
-/*const std::wstring signs1[signs1_sz] = {
-  L"=", L"<<=", L">>=", L"+=", L"-=", L"*=", L"**=", L"/=",
-  L"^=", L"&=", L"|=", L"%="
+// Calls function whose stack item is already pushed with arguments stored in it;
+// returned value, if there is one, is put onto the stack
+void CallPushedFunction(const std::string & internal_name, const std::shared_ptr<TIDVariableType> & return_type) {
+  // Return pointer is the instruction right after kCall
+  uint64_t return_ind = rpn.back()->GetNodes().size();
+  PushNode(RPNRelativeOperand(0));
+  PushNode(RPNOperand(0));
+  PushNode(RPNOperator(RPNOperatorType::kFromSP));
+  PushNode(RPNOperator(RPNOperatorType::kStoreDA, PrimitiveVariableType::kUint64));
+  PushNode(RPNReferenceOperand(internal_name));
+  PushNode(RPNOperator(RPNOperatorType::kCall));
+  rpn.back()->GetNodes()[return_ind] = std::make_shared<RPNRelativeOperand>(rpn.back()->GetNodes().size());
+
+  if (return_type) {
+    PushNode(RPNOperand(9));
+    PushNode(RPNOperator(RPNOperatorType::kFromSP));
+  }
+  PushNode(RPNOperator(RPNOperatorType::kPop));
+  if (!return_type) return;
+  if (return_type->GetType() == VariableType::kComplex) {
+    // popped stack item is not overwritten yet, copying value to our temporary
+    uint64_t address = tid.AddTemporaryInstance(lexeme, return_type);
+    PushNode(RPNOperand(address));
+    PushNode(RPNOperator(RPNOperatorType::kFromSP));
+    PushNode(RPNOperator(RPNOperatorType::kDuplicate));
+    PushNode(RPNOperator(RPNOperatorType::kSave));
+    PushNode(RPNOperand(return_type->GetSize()));
+    PushNode(RPNOperator(RPNOperatorType::kCopyFT));
+    PushNode(RPNOperator(RPNOperatorType::kRestore));
+  } else {
+    PushNode(RPNOperator(RPNOperatorType::kLoad,
+                         IsReference(return_type) ? PrimitiveVariableType::kUint64 : GetTypeOfVariable(return_type)));
+  }
+}
+
+const size_t signs1_sz = 12;
+/*const std::string signs1[signs1_sz] = {
+  "=", "<<=", ">>=", "+=", "-=", "*=", "**=", "/=",
+  "^=", "&=", "|=", "%="
 };*/
 const BinaryOperator signs1[signs1_sz] = {
   BinaryOperator::kAssignment, BinaryOperator::kBitwiseShiftLeftAssignment, BinaryOperator::kBitwiseShiftRightAssignment,
   BinaryOperator::kAdditionAssignment, BinaryOperator::kSubtractionAssignment, BinaryOperator::kMultiplicationAssignment,
-  BinaryOperator::kDivisionAssignment, BinaryOperator::kBitwiseXorAssignment, BinaryOperator::kBitwiseOrAssignment,
-  BinaryOperator::kBitwiseAndAssignment, BinaryOperator::kModulusAssignment
+  BinaryOperator::kExponentiationAssignment, BinaryOperator::kDivisionAssignment, BinaryOperator::kBitwiseXorAssignment,
+  BinaryOperator::kBitwiseOrAssignment, BinaryOperator::kBitwiseAndAssignment, BinaryOperator::kModulusAssignment
 };
 
 std::shared_ptr<TIDValue> Priority1() {
@@ -1074,29 +1995,90 @@ std::shared_ptr<TIDValue> Priority1() {
   return st[0].second;
 }
 
+// Sets operands of jumps at given indices to target
+void SetJumps(const std::vector<uint64_t> & operands, uint64_t target) {
+  for (uint64_t i : operands)
+    rpn.back()->GetNodes()[i] = std::make_shared<RPNRelativeOperand>(target);
+}
+
+// Emits jump of type op to be set later; returns index of its operand
+uint64_t PushJump(RPNOperatorType op) {
+  uint64_t index = rpn.back()->GetNodes().size();
+  PushNode(RPNRelativeOperand(0));
+  PushNode(RPNOperator(op));
+  return index;
+}
+
+// Parses condition of a branch and emits jump (kJz) for false case;
+// returns operands of jumps that have to be set to where false case goes
+std::vector<uint64_t> Condition() {
+  BranchFusion branch;
+  fusion = &branch;
+  std::shared_ptr<TIDValue> value = Expression();
+  fusion = nullptr;
+  Cast(value, SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kBool), true));
+  branch.false_jumps.push_back(PushJump(RPNOperatorType::kJz));
+  SetJumps(branch.true_jumps, rpn.back()->GetNodes().size());
+  return branch.false_jumps;
+}
+
+// Right operand is evaluated only if left one is false.
+// Materialized: a; dup; jnz end; dump; b; end:
+// Fused into branch: a; jnz then; b (checked by branch)
 std::shared_ptr<TIDValue> Priority2() {
-  auto val = Priority3();
-  while (IsLexeme(LexemeType::kOperator, L"||")) {
+  BranchFusion * branch = fusion;
+  fusion = nullptr;
+  auto bool_type = SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kBool), true);
+  std::vector<uint64_t> and_false_jumps, to_end;
+  auto val = Priority3(branch ? &and_false_jumps : nullptr);
+  while (IsLexeme(LexemeType::kOperator, "||")) {
     GetNext();
-    auto new_val = Priority3();
-    val = BinaryOperationRPN(val, BinaryOperator::kLogicalOr, new_val, lexeme, *rpn.back());
+    Cast(val, bool_type, true);
+    if (branch) {
+      branch->true_jumps.push_back(PushJump(RPNOperatorType::kJnz));
+      // false && chain goes on to next operand
+      SetJumps(and_false_jumps, rpn.back()->GetNodes().size());
+      and_false_jumps.clear();
+    } else {
+      PushNode(RPNOperator(RPNOperatorType::kDuplicate));
+      to_end.push_back(PushJump(RPNOperatorType::kJnz));
+      PushNode(RPNOperator(RPNOperatorType::kDump));
+    }
+    Cast(Priority3(branch ? &and_false_jumps : nullptr), bool_type, true);
+    val = std::make_shared<TIDTemporaryValue>(bool_type);
   }
+  if (branch)
+    branch->false_jumps.insert(branch->false_jumps.end(), and_false_jumps.begin(), and_false_jumps.end());
+  SetJumps(to_end, rpn.back()->GetNodes().size());
   return val;
 }
 
-std::shared_ptr<TIDValue> Priority3() {
+// Right operand is evaluated only if left one is true; if false_jumps is given, jumps for false
+// are added to it instead of materializing false
+std::shared_ptr<TIDValue> Priority3(std::vector<uint64_t> * false_jumps) {
+  auto bool_type = SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kBool), true);
+  std::vector<uint64_t> to_end;
   auto val = Priority4();
-  while (IsLexeme(LexemeType::kOperator, L"&&")) {
+  while (IsLexeme(LexemeType::kOperator, "&&")) {
     GetNext();
-    auto new_val = Priority4();
-    val = BinaryOperationRPN(val, BinaryOperator::kLogicalAnd, new_val, lexeme, *rpn.back());
+    Cast(val, bool_type, true);
+    if (false_jumps) {
+      false_jumps->push_back(PushJump(RPNOperatorType::kJz));
+    } else {
+      PushNode(RPNOperator(RPNOperatorType::kDuplicate));
+      to_end.push_back(PushJump(RPNOperatorType::kJz));
+      PushNode(RPNOperator(RPNOperatorType::kDump));
+    }
+    Cast(Priority4(), bool_type, true);
+    val = std::make_shared<TIDTemporaryValue>(bool_type);
   }
+  SetJumps(to_end, rpn.back()->GetNodes().size());
   return val;
 }
 
 std::shared_ptr<TIDValue> Priority4() {
   auto val = Priority5();
-  while (IsLexeme(LexemeType::kOperator, L"|")) {
+  while (IsLexeme(LexemeType::kOperator, "|")) {
     GetNext();
     auto new_val = Priority5();
     val = BinaryOperationRPN(val, BinaryOperator::kBitwiseOr, new_val, lexeme, *rpn.back());
@@ -1106,7 +2088,7 @@ std::shared_ptr<TIDValue> Priority4() {
 
 std::shared_ptr<TIDValue> Priority5() {
   auto val = Priority6();
-  while (IsLexeme(LexemeType::kOperator, L"^")) {
+  while (IsLexeme(LexemeType::kOperator, "^")) {
     GetNext();
     auto new_val = Priority6();
     val = BinaryOperationRPN(val, BinaryOperator::kBitwiseXor, new_val, lexeme, *rpn.back());
@@ -1116,7 +2098,7 @@ std::shared_ptr<TIDValue> Priority5() {
 
 std::shared_ptr<TIDValue> Priority6() {
   auto val = Priority7();
-  while (IsLexeme(LexemeType::kOperator, L"&")) {
+  while (IsLexeme(LexemeType::kOperator, "&")) {
     GetNext();
     auto new_val = Priority7();
     val = BinaryOperationRPN(val, BinaryOperator::kBitwiseAnd, new_val, lexeme, *rpn.back());
@@ -1126,9 +2108,9 @@ std::shared_ptr<TIDValue> Priority6() {
 
 std::shared_ptr<TIDValue> Priority7() {
   auto val = Priority8();
-  while (IsLexeme(LexemeType::kOperator, L"==")
-      || IsLexeme(LexemeType::kOperator, L"!=")) {
-    BinaryOperator op = IsLexeme(LexemeType::kOperator, L"==") ? BinaryOperator::kEqual : BinaryOperator::kNotEqual;
+  while (IsLexeme(LexemeType::kOperator, "==")
+      || IsLexeme(LexemeType::kOperator, "!=")) {
+    BinaryOperator op = IsLexeme(LexemeType::kOperator, "==") ? BinaryOperator::kEqual : BinaryOperator::kNotEqual;
     GetNext();
     auto new_val = Priority8();
     val = BinaryOperationRPN(val, op, new_val, lexeme, *rpn.back());
@@ -1138,16 +2120,16 @@ std::shared_ptr<TIDValue> Priority7() {
 
 std::shared_ptr<TIDValue> Priority8() {
   auto val = Priority9();
-  while (IsLexeme(LexemeType::kOperator, L"<")
-      || IsLexeme(LexemeType::kOperator, L"<=")
-      || IsLexeme(LexemeType::kOperator, L">")
-      || IsLexeme(LexemeType::kOperator, L">=")) {
+  while (IsLexeme(LexemeType::kOperator, "<")
+      || IsLexeme(LexemeType::kOperator, "<=")
+      || IsLexeme(LexemeType::kOperator, ">")
+      || IsLexeme(LexemeType::kOperator, ">=")) {
     BinaryOperator op = BinaryOperator::kLess;
-    if (IsLexeme(LexemeType::kOperator, L"<="))
+    if (IsLexeme(LexemeType::kOperator, "<="))
       op = BinaryOperator::kLessOrEqual;
-    else if (IsLexeme(LexemeType::kOperator, L">"))
+    else if (IsLexeme(LexemeType::kOperator, ">"))
       op = BinaryOperator::kMore;
-    else if (IsLexeme(LexemeType::kOperator, L">="))
+    else if (IsLexeme(LexemeType::kOperator, ">="))
       op = BinaryOperator::kMoreOrEqual;
     GetNext();
     auto new_val = Priority9();
@@ -1158,9 +2140,9 @@ std::shared_ptr<TIDValue> Priority8() {
 
 std::shared_ptr<TIDValue> Priority9() {
   auto val = Priority10();
-  while (IsLexeme(LexemeType::kOperator, L"<<")
-      || IsLexeme(LexemeType::kOperator, L">>")) {
-    BinaryOperator op = IsLexeme(LexemeType::kOperator, L"<<") ? BinaryOperator::kBitwiseShiftLeft
+  while (IsLexeme(LexemeType::kOperator, "<<")
+      || IsLexeme(LexemeType::kOperator, ">>")) {
+    BinaryOperator op = IsLexeme(LexemeType::kOperator, "<<") ? BinaryOperator::kBitwiseShiftLeft
         : BinaryOperator::kBitwiseShiftRight;
     GetNext();
     auto new_val = Priority10();
@@ -1171,9 +2153,9 @@ std::shared_ptr<TIDValue> Priority9() {
 
 std::shared_ptr<TIDValue> Priority10() {
   auto val = Priority11();
-  while (IsLexeme(LexemeType::kOperator, L"+")
-      || IsLexeme(LexemeType::kOperator, L"-")) {
-    BinaryOperator op = IsLexeme(LexemeType::kOperator, L"+") ? BinaryOperator::kAddition
+  while (IsLexeme(LexemeType::kOperator, "+")
+      || IsLexeme(LexemeType::kOperator, "-")) {
+    BinaryOperator op = IsLexeme(LexemeType::kOperator, "+") ? BinaryOperator::kAddition
         : BinaryOperator::kSubtraction;
     GetNext();
     auto new_val = Priority11();
@@ -1183,44 +2165,64 @@ std::shared_ptr<TIDValue> Priority10() {
 }
 
 std::shared_ptr<TIDValue> Priority11() {
-  auto val = Priority12();
-  while (IsLexeme(LexemeType::kOperator, L"*")
-      || IsLexeme(LexemeType::kOperator, L"/")
-      || IsLexeme(LexemeType::kOperator, L"%")) {
+  auto val = PriorityPower();
+  while (IsLexeme(LexemeType::kOperator, "*")
+      || IsLexeme(LexemeType::kOperator, "/")
+      || IsLexeme(LexemeType::kOperator, "%")) {
     BinaryOperator op = BinaryOperator::kModulus;
-    if (IsLexeme(LexemeType::kOperator, L"*")) {
+    if (IsLexeme(LexemeType::kOperator, "*")) {
       op = BinaryOperator::kMultiplication;
-    } else if (IsLexeme(LexemeType::kOperator, L"/")) {
+    } else if (IsLexeme(LexemeType::kOperator, "/")) {
       op = BinaryOperator::kDivision;
     }
     GetNext();
-    auto new_val = Priority12();
+    auto new_val = PriorityPower();
     val = BinaryOperationRPN(val, op, new_val, lexeme, *rpn.back());
   }
   return val;
 }
 
+// ** is right to left and binds tighter than * but not than unary operators.
+// Lexer reads "a**p" as a ** p, so if p is a pointer it is a * (*p) instead
+std::shared_ptr<TIDValue> PriorityPower() {
+  auto val = Priority12();
+  if (!IsLexeme(LexemeType::kOperator, "**"))
+    return val;
+  GetNext();
+  auto new_val = PriorityPower();
+  auto new_type = new_val->GetType();
+  if (new_type && new_type->GetType() == VariableType::kPointer) {
+    new_val = UnaryPrefixOperationRPN(UnaryPrefixOperator::kDereference, new_val, lexeme, *rpn.back());
+    return BinaryOperationRPN(val, BinaryOperator::kMultiplication, new_val, lexeme, *rpn.back());
+  }
+  return BinaryOperationRPN(val, BinaryOperator::kExponentiation, new_val, lexeme, *rpn.back());
+}
+
 std::shared_ptr<TIDValue> Priority12() {
   std::vector<UnaryPrefixOperator> ops;
   while (true) {
     UnaryPrefixOperator op = UnaryPrefixOperator::kUnknown;
-    if (IsLexeme(LexemeType::kOperator, L"+"))
+    if (IsLexeme(LexemeType::kOperator, "+"))
       op = UnaryPrefixOperator::kPlus;
-    else if (IsLexeme(LexemeType::kOperator, L"-"))
+    else if (IsLexeme(LexemeType::kOperator, "-"))
       op = UnaryPrefixOperator::kMinus;
-    else if (IsLexeme(LexemeType::kOperator, L"++"))
+    else if (IsLexeme(LexemeType::kOperator, "++"))
       op = UnaryPrefixOperator::kIncrement;
-    else if (IsLexeme(LexemeType::kOperator, L"--"))
+    else if (IsLexeme(LexemeType::kOperator, "--"))
       op = UnaryPrefixOperator::kDecrement;
-    else if (IsLexeme(LexemeType::kOperator, L"!"))
+    else if (IsLexeme(LexemeType::kOperator, "!"))
       op = UnaryPrefixOperator::kInvert;
-    else if (IsLexeme(LexemeType::kOperator, L"~"))
+    else if (IsLexeme(LexemeType::kOperator, "~"))
       op = UnaryPrefixOperator::kTilda;
-    else if (IsLexeme(LexemeType::kOperator, L"&"))
+    else if (IsLexeme(LexemeType::kOperator, "&"))
       op = UnaryPrefixOperator::kAddressOf;
-    else if (IsLexeme(LexemeType::kOperator, L"*"))
+    else if (IsLexeme(LexemeType::kOperator, "*"))
       op = UnaryPrefixOperator::kDereference;
-    else
+    else if (IsLexeme(LexemeType::kOperator, "**")) {
+      // lexer reads "**p" as one operator
+      ops.push_back(UnaryPrefixOperator::kDereference);
+      op = UnaryPrefixOperator::kDereference;
+    } else
       break;
     GetNext();
     ops.push_back(op);
@@ -1237,14 +2239,14 @@ std::shared_ptr<TIDValue> Priority13() {
   auto val = Priority14();
   auto type = val->GetType();
   while (true) {
-    if (IsLexeme(LexemeType::kBracket, L"[")) {
+    if (IsLexeme(LexemeType::kBracket, "[")) {
       if (!type || type->GetType() != VariableType::kArray)
         throw TypeNotIndexed(lexeme);
       GetNext();
       LoadIfReference(val, *rpn.back());
       auto index_val = Expression();
       Cast(index_val, SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kUint32), true));
-      Expect(LexemeType::kBracket, L"]");
+      Expect(LexemeType::kBracket, "]");
       GetNext();
       type = SetReferenceToType(std::static_pointer_cast<TIDArrayVariableType>(type)->GetValue(), true);
       val = std::make_shared<TIDTemporaryValue>(type);
@@ -1253,21 +2255,21 @@ std::shared_ptr<TIDValue> Priority13() {
       PushNode(RPNOperand(4));
       PushNode(RPNOperator(RPNOperatorType::kAdd, PrimitiveVariableType::kUint64));
       PushNode(RPNOperator(RPNOperatorType::kAdd, PrimitiveVariableType::kUint64));
-    } else if (IsLexeme(LexemeType::kParenthesis, L"(")) {
+    } else if (IsLexeme(LexemeType::kParenthesis, "(")) {
       if (!type || type->GetType() != VariableType::kFunction)
         throw TypeNotCallable(lexeme);
-      std::wstring name;
+      std::string name;
       if (val->GetValueType() == TIDValueType::kVariable)
         name = std::static_pointer_cast<TIDVariable>(val)->GetName();
       FunctionCall(val);
       val = std::make_shared<TIDTemporaryValue>(std::static_pointer_cast<TIDFunctionVariableType>(type)->GetReturnType());
       type = val->GetType();
-    } else if (IsLexeme(LexemeType::kOperator, L".")) {
+    } else if (IsLexeme(LexemeType::kOperator, ".")) {
       if (!type || type->GetType() != VariableType::kComplex)
         throw TypeNoMembers(lexeme);
       GetNext();
       Expect(LexemeType::kIdentifier);
-      std::wstring member_name = lexeme.GetValue();
+      std::string member_name = lexeme.GetValue();
       auto complex_type = std::dynamic_pointer_cast<TIDComplexVariableType>(type);
       auto new_type = complex_type->GetField(member_name);
       if (new_type == nullptr)
@@ -1278,13 +2280,13 @@ std::shared_ptr<TIDValue> Priority13() {
       val = std::make_shared<TIDTemporaryValue>(type);
       PushNode(RPNOperand(offset));
       PushNode(RPNOperator(RPNOperatorType::kAdd, PrimitiveVariableType::kUint64));
-    } else if (IsLexeme(LexemeType::kOperator, L"++") || IsLexeme(LexemeType::kOperator, L"--")) {
-      UnaryPostfixOperator op = IsLexeme(LexemeType::kOperator, L"++") ? UnaryPostfixOperator::kIncrement
+    } else if (IsLexeme(LexemeType::kOperator, "++") || IsLexeme(LexemeType::kOperator, "--")) {
+      UnaryPostfixOperator op = IsLexeme(LexemeType::kOperator, "++") ? UnaryPostfixOperator::kIncrement
         : UnaryPostfixOperator::kDecrement;
       GetNext();
       val = UnaryPostfixOperationRPN(val, op, lexeme, *rpn.back());
       type = val->GetType();
-    } else if (IsLexeme(LexemeType::kReserved, L"as")) {
+    } else if (IsLexeme(LexemeType::kReserved, "as")) {
       GetNext();
       std::shared_ptr<TIDVariableType> new_type = Type(true);
       Cast(val, new_type, true);
@@ -1297,34 +2299,22 @@ std::shared_ptr<TIDValue> Priority13() {
 }
 
 std::shared_ptr<TIDValue> Priority14() {
-  if (IsLexeme(LexemeType::kParenthesis, L"(")) {
+  if (IsLexeme(LexemeType::kParenthesis, "(")) {
     GetNext();
     auto type = Expression();
-    Expect(LexemeType::kParenthesis, L")");
+    Expect(LexemeType::kParenthesis, ")");
     GetNext();
     return type;
   } else {
     std::shared_ptr<TIDValue> val;
-    if (IsLexeme(LexemeType::kReserved, L"new") || IsLexeme(LexemeType::kReserved, L"delete") ||
-        IsLexeme(LexemeType::kReserved, L"size") || IsLexeme(LexemeType::kReserved, L"sizeof") ||
-        IsLexeme(LexemeType::kReserved, L"read") || IsLexeme(LexemeType::kReserved, L"write")) {
-      if (IsLexeme(LexemeType::kReserved, L"new")) val = New();
-      else if (IsLexeme(LexemeType::kReserved, L"delete")) val = Delete();
-      else if (IsLexeme(LexemeType::kReserved, L"size")) val = Size();
-      else if (IsLexeme(LexemeType::kReserved, L"sizeof")) val = Sizeof();
-      else if (IsLexeme(LexemeType::kReserved, L"read")) val = Read();
-      else val = Write();
-      return val;
+    if (IsBuiltin()) {
+      return builtins.at(lexeme.GetValue())();
     } else if (IsLexeme(LexemeType::kNumericLiteral)) {
-      PrimitiveVariableType primitive_type = NumericTypeFromString(lexeme.GetValue());
       val = std::make_shared<TIDTemporaryValue>(SetConstToType(
-          GetPrimitiveVariableType(primitive_type), true));
-      uint64_t value = (primitive_type == PrimitiveVariableType::kF32 ||
-        primitive_type == PrimitiveVariableType::kF64) ? DecimalFromString(lexeme.GetValue(), primitive_type)
-                                                       : IntegerFromString(lexeme.GetValue(), primitive_type);
-        PushNode(RPNOperand(value));
+          GetPrimitiveVariableType(lexeme.GetLiteralType()), true));
+      PushNode(RPNOperand(lexeme.GetLiteral()));
     } else if (IsLexeme(LexemeType::kIdentifier)) {
-      if (lexeme.GetValue() == L"nullptr") {
+      if (lexeme.GetValue() == "nullptr") {
         PushNode(RPNOperand(-2ull));
         return std::make_shared<TIDTemporaryValue>(SetConstToType(DerivePointerFromType(
                 GetPrimitiveVariableType(PrimitiveVariableType::kUint64)), true));
@@ -1332,18 +2322,18 @@ std::shared_ptr<TIDValue> Priority14() {
       std::shared_ptr<TIDVariableType> struct_type = tid.GetComplexStruct(lexeme.GetValue());
       if (struct_type) {
         GetNext();
-        Expect(LexemeType::kParenthesis, L"(");
+        Expect(LexemeType::kParenthesis, "(");
         GetNext();
-        Expect(LexemeType::kParenthesis, L")");
+        Expect(LexemeType::kParenthesis, ")");
         val = std::make_shared<TIDTemporaryValue>(SetParamsToType(struct_type, true, false));
         uint64_t address = tid.AddTemporaryInstance(lexeme, val->GetType());
         PushNode(RPNOperand(address));
         PushNode(RPNOperator(RPNOperatorType::kFromSP));
         PushNode(RPNOperator(RPNOperatorType::kDuplicate));
-        std::wstring internal_name = std::dynamic_pointer_cast<TIDComplexVariableType>(struct_type)->GetInternalName();
-        auto def_var = tid.GetVariable(internal_name + L"$def");
+        std::string internal_name = std::dynamic_pointer_cast<TIDComplexVariableType>(struct_type)->GetInternalName();
+        auto def_var = tid.GetVariable(internal_name + "$def");
         assert(def_var && def_var->GetType());
-        tid.LoadVariableAddress(internal_name + L"$def", *rpn.back());
+        tid.LoadVariableAddress(internal_name + "$def", *rpn.back());
         LoadIfReference(def_var, *rpn.back());
         PushNode(RPNOperand(struct_type->GetSize()));
         PushNode(RPNOperator(RPNOperatorType::kCopyTF));
@@ -1375,7 +2365,7 @@ std::shared_ptr<TIDValue> Priority14() {
       PushNode(RPNOperator(RPNOperatorType::kStoreAD, PrimitiveVariableType::kUint32));
 
       for (uint64_t i = 0; i < lexeme.GetValue().size(); ++i) {
-        wchar_t ch = lexeme.GetValue()[i];
+        char ch = lexeme.GetValue()[i];
         PushNode(RPNOperator(RPNOperatorType::kDuplicate));
         PushNode(RPNOperand(i + 4));
         PushNode(RPNOperator(RPNOperatorType::kAdd, PrimitiveVariableType::kUint64));
@@ -1386,12 +2376,12 @@ std::shared_ptr<TIDValue> Priority14() {
       val = std::make_shared<TIDTemporaryValue>(
           SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kChar), true)
       );
-      PushNode(RPNOperand(static_cast<unsigned char>(lexeme.GetValue()[0])));
-    } else if (IsLexeme(LexemeType::kReserved, L"true") || IsLexeme(LexemeType::kReserved, L"false")) {
+      PushNode(RPNOperand(lexeme.GetLiteral()));
+    } else if (IsLexeme(LexemeType::kReserved, "true") || IsLexeme(LexemeType::kReserved, "false")) {
       val = std::make_shared<TIDTemporaryValue>(
           SetConstToType(GetPrimitiveVariableType(PrimitiveVariableType::kBool), true)
       );
-      PushNode(RPNOperand(IsLexeme(LexemeType::kReserved, L"true")));
+      PushNode(RPNOperand(IsLexeme(LexemeType::kReserved, "true")));
     }
     if (!val)
       throw ExpectedExpression(lexeme);
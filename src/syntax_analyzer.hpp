@@ -1,7 +1,34 @@
 #pragma once
 
-#include <vector>
-#include "lexeme.hpp"
+#include "lexical_analyzer.hpp"
 #include "generation.hpp"
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// RPN of a top-level function body; it stays valid while the body and all lexemes outside
+// of function bodies before it are the same
+struct CachedFunction {
+  uint64_t context;                                          // hash of lexemes outside of function bodies
+  std::vector<std::pair<LexemeType, SymbolId>> body;         // from "{" to "}"
+  // Function itself and functions nested in it: internal name, RPN, stack size
+  std::vector<std::tuple<std::string, std::vector<std::shared_ptr<RPNNode>>, uint64_t>> functions;
+};
+
+// Kept between analyses of edited source, so unchanged functions are not parsed again
+struct ParseCache {
+  std::map<std::string, CachedFunction> functions;         // by internal name
+  size_t reused = 0;                                         // by the last analysis
+  size_t parsed = 0;
+};
 
-RPN PerformSyntaxAnalysis(const std::vector<Lexeme> & lexemes);
+// Builds RPN of global code and of every function, pulling lexemes from lexer as it goes;
+// with cache, bodies of unchanged functions are taken from it (their warnings are not reported again)
+void PerformSyntaxAnalysis(Lexer & lexer, ParseCache * cache = nullptr);
+// Forgets everything analyzed, so that another source can be analyzed
+void ResetSyntaxAnalysis();
+// Lays out global code and functions into one program and resolves function addresses
+RPN PerformLinking();
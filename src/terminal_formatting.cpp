@@ -1,7 +1,19 @@
 #include "terminal_formatting.hpp"
 
+#include <algorithm>
 #include <sstream>
 
+#include "source.hpp"
+
+std::wostream &operator<<(std::wostream &out, std::string_view text) {
+  for (size_t i = 0; i < text.size();) {
+    size_t length = std::max<size_t>(Utf8SequenceLength(text, i), 1);
+    out << DecodeUtf8(text, i, length);
+    i += length;
+  }
+  return out;
+}
+
 // Formatting
 std::wostream &format::reset(std::wostream &out) {
   out << "\033[0m";
@@ -1,6 +1,10 @@
 #pragma once
 
 #include <sstream>
+#include <string_view>
+
+// Compiler keeps text in UTF-8, it is decoded only when written to terminal
+std::wostream &operator<<(std::wostream &out, std::string_view text);
 
 namespace format {
     // Formatting